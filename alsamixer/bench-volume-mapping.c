@@ -0,0 +1,142 @@
+/*
+ * Measures the volume mapping kernel; run by "make bench".
+ *
+ * Reads convert a dB or raw value to a slider position, writes convert a
+ * slider position back, both computed and through the per-step table that
+ * volume_mapping.c builds for elements with a dB TLV.  The bulk rows convert
+ * BULK values per call, as when restoring all channels of many controls.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "volume_mapping_kernel.h"
+
+#define ITERATIONS	2000000
+#define BULK		64
+
+struct bench_range {
+	const char *name;
+	bool have_dB;
+	long dB_min, dB_max;
+	long raw_min, raw_max;
+};
+
+static const struct bench_range ranges[] = {
+	{ "linear dB", true, -2400, 0, 0, 31 },
+	{ "cubic", true, -6350, 0, 0, 127 },
+	{ "cubic, mute", true, VOLUME_MAPPING_DB_GAIN_MUTE, 0, 0, 255 },
+	{ "raw", false, 0, 0, 0, 65536 },
+};
+
+/* keeps the compiler from dropping the measured work */
+static volatile double sink;
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void report(const char *range, const char *what, double start)
+{
+	printf("%-12s %-14s %8.2f ns/op\n", range, what,
+	       (now_ns() - start) / ITERATIONS);
+}
+
+static void bench(const struct bench_range *b)
+{
+	struct volume_range range;
+	long steps = b->raw_max - b->raw_min + 1;
+	long span, i, *values = NULL;
+	double *table = NULL, acc, start;
+
+	volume_range_init(&range, VOLUME_MAPPING_CURVE_AUTO, b->have_dB,
+			  b->dB_min, b->dB_max, b->raw_min, b->raw_max);
+	span = range.max - range.min + 1;
+
+	acc = 0;
+	start = now_ns();
+	for (i = 0; i < ITERATIONS; i++)
+		acc += volume_range_to_normalized(&range, range.min + i % span);
+	report(b->name, "read", start);
+	sink = acc;
+
+	acc = 0;
+	start = now_ns();
+	for (i = 0; i < ITERATIONS; i++)
+		acc += volume_range_from_normalized(&range, (i % 1000) / 999.0, i % 3 - 1);
+	report(b->name, "write", start);
+	sink = acc;
+
+	{
+		long bulk_values[BULK];
+		double bulk_volumes[BULK];
+
+		for (i = 0; i < BULK; i++) {
+			bulk_values[i] = range.min + i % span;
+			bulk_volumes[i] = (i % 1000) / 999.0;
+		}
+
+		acc = 0;
+		start = now_ns();
+		for (i = 0; i < ITERATIONS; i += BULK) {
+			volume_range_to_normalized_n(&range, bulk_values, bulk_volumes, BULK);
+			acc += bulk_volumes[i % BULK];
+		}
+		report(b->name, "read (bulk)", start);
+		sink = acc;
+
+		for (i = 0; i < BULK; i++)
+			bulk_volumes[i] = (i * 37 % 1000) / 999.0;
+
+		acc = 0;
+		start = now_ns();
+		for (i = 0; i < ITERATIONS; i += BULK) {
+			volume_range_from_normalized_n(&range, bulk_volumes, bulk_values, BULK, 1);
+			acc += bulk_values[i % BULK];
+		}
+		report(b->name, "write (bulk)", start);
+		sink = acc;
+	}
+
+	if (range.scale == VOLUME_MAPPING_RAW)
+		return;
+
+	values = malloc(steps * sizeof(*values));
+	table = malloc(steps * sizeof(*table));
+	if (!values || !table)
+		abort();
+	for (i = 0; i < steps; i++)
+		values[i] = range.min + (range.max - range.min) * i / (steps - 1);
+	volume_table_fill(&range, values, steps, table);
+
+	acc = 0;
+	start = now_ns();
+	for (i = 0; i < ITERATIONS; i++)
+		acc += table[i % steps];
+	report(b->name, "read (table)", start);
+	sink = acc;
+
+	acc = 0;
+	start = now_ns();
+	for (i = 0; i < ITERATIONS; i++)
+		acc += volume_table_lookup(table, steps, (i % 1000) / 999.0, i % 3 - 1);
+	report(b->name, "write (table)", start);
+	sink = acc;
+
+	free(values);
+	free(table);
+}
+
+int main(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++)
+		bench(&ranges[i]);
+
+	return EXIT_SUCCESS;
+}
@@ -23,20 +23,109 @@
 #include <config.h>
 #endif
 
+#include <stdio.h>
+
 #include <glib/gi18n.h>
+#include <gio/gio.h>
 
 #include "gam-app.h"
+#include "gam-card.h"
 #include "gam-mixer.h"
 #include "gam-prefs-dlg.h"
 
+enum {
+    MIXER_LOADED,
+    LAST_SIGNAL
+};
+
 struct _GamAppPrivate
 {
     GtkWidget      *notebook;
+
+    gboolean        iconified;
+
+    /* /dev/snd, to see cards come and go */
+    GFileMonitor   *card_monitor;
+
+    /* seconds a tab may stay hidden before its mixer is unloaded, or 0 */
+    guint           unload_time;
+    guint           unload_timeout_id;
+
+    /* cards whose mixers are never unloaded, and how often each is pinned */
+    GHashTable     *pinned;
 };
 
+/*
+ * Every tab starts out as an empty box that only knows its card; the mixer
+ * is built into it the first time the tab is shown, and may be unloaded
+ * again when the tab has not been shown for a while.  Cards are probed and
+ * opened on the threads of gam_card_load_async(), so that a slow card only
+ * holds up its own tab.
+ */
+typedef struct
+{
+    gchar     *card;
+    gchar     *style;
+    GtkWidget *mixer;
+    /* takes the place of the mixer, and spins while the card is opened */
+    GtkWidget *spinner;
+
+    /* the names of the card are being read; again once that is done */
+    gboolean   probing;
+    gboolean   probe_again;
+    /* the card is being opened for the mixer */
+    gboolean   loading;
+
+    /* when the mixer was last shown, in monotonic time */
+    gint64     shown_time;
+} GamAppPage;
+
+#define GAM_APP_PAGE_KEY "gam-app-page"
+
 static gboolean  gam_app_delete                        (GtkWidget             *widget,
                                                         gpointer               user_data);
 static void      gam_app_destroy                       (GtkWidget             *widget);
+static void      gam_app_map                           (GtkWidget             *widget);
+static void      gam_app_unmap                         (GtkWidget             *widget);
+static gboolean  gam_app_window_state_event            (GtkWidget             *widget,
+                                                        GdkEventWindowState   *event);
+static gboolean  gam_app_key_press_event               (GtkWidget             *widget,
+                                                        GdkEventKey           *event);
+static void      gam_app_switch_page_cb                (GtkNotebook           *notebook,
+                                                        GtkWidget             *page,
+                                                        guint                  page_num,
+                                                        GamApp                *gam_app);
+static void      gam_app_park_mixers                   (GamApp                *gam_app,
+                                                        GtkWidget             *current);
+static GtkWidget *gam_app_new_mixer                    (GamApp                *gam_app,
+                                                        GamCard               *card,
+                                                        const gchar           *style);
+static GtkWidget *gam_app_page_get_mixer               (GtkWidget             *page);
+static GtkWidget *gam_app_page_load                    (GamApp                *gam_app,
+                                                        GtkWidget             *page);
+static void      gam_app_page_unload                   (GtkWidget             *page);
+static void      gam_app_page_probe                    (GamApp                *gam_app,
+                                                        GtkWidget             *page);
+static void      gam_app_card_probed_cb                (GamCard               *card,
+                                                        gpointer               data);
+static void      gam_app_card_loaded_cb                (GamCard               *card,
+                                                        gpointer               data);
+static gboolean  gam_app_unload_pages                  (gpointer               data);
+static gint      gam_app_find_page                     (GamApp                *gam_app,
+                                                        const gchar           *card);
+static GtkWidget *gam_app_lookup_page                  (GamApp                *gam_app,
+                                                        const gchar           *card);
+static void      gam_app_add_card                      (GamApp                *gam_app,
+                                                        const gchar           *card);
+static void      gam_app_remove_card                   (GamApp                *gam_app,
+                                                        const gchar           *card);
+static void      gam_app_mixer_disconnected_cb         (GamMixer              *gam_mixer,
+                                                        GamApp                *gam_app);
+static void      gam_app_card_monitor_cb               (GFileMonitor          *monitor,
+                                                        GFile                 *file,
+                                                        GFile                 *other_file,
+                                                        GFileMonitorEvent      event_type,
+                                                        GamApp                *gam_app);
 static GObject  *gam_app_constructor                   (GType                  type,
                                                         guint                  n_construct_properties,
                                                         GObjectConstructParam *construct_params);
@@ -49,6 +138,8 @@ static void      gam_app_switch_mixer_ui               (GtkWidget             *b
                                                         GamApp                *gam_app);
 
 static gpointer parent_class;
+static guint    signals[LAST_SIGNAL] = { 0 };
+static gint     volume_curve = 0;
 
 G_DEFINE_TYPE_WITH_CODE (GamApp , gam_app, GTK_TYPE_WINDOW,
                          G_ADD_PRIVATE (GamApp))
@@ -67,6 +158,18 @@ gam_app_class_init (GamAppClass *klass)
     gobject_class->constructor = gam_app_constructor;
 
     widget_class->destroy = gam_app_destroy;
+    widget_class->map = gam_app_map;
+    widget_class->unmap = gam_app_unmap;
+    widget_class->window_state_event = gam_app_window_state_event;
+    widget_class->key_press_event = gam_app_key_press_event;
+
+    signals[MIXER_LOADED] =
+        g_signal_new ("mixer_loaded",
+                      G_OBJECT_CLASS_TYPE (gobject_class),
+                      G_SIGNAL_RUN_FIRST,
+                      G_STRUCT_OFFSET (GamAppClass, mixer_loaded),
+                      NULL, NULL, NULL,
+                      G_TYPE_NONE, 1, G_TYPE_STRING);
 }
 
 static void
@@ -75,9 +178,16 @@ gam_app_init (GamApp *gam_app)
     g_return_if_fail (GAM_IS_APP (gam_app));
 
     gam_app->priv = gam_app_get_instance_private (gam_app);
+    gam_app->priv->iconified = FALSE;
+    gam_app->priv->card_monitor = NULL;
+    gam_app->priv->unload_time = 0;
+    gam_app->priv->unload_timeout_id = 0;
+    gam_app->priv->pinned = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
     gam_app->priv->notebook = gtk_notebook_new ();
     gtk_notebook_set_scrollable (GTK_NOTEBOOK (gam_app->priv->notebook), TRUE);
     gtk_notebook_set_tab_pos (GTK_NOTEBOOK (gam_app->priv->notebook), GTK_POS_TOP);
+    g_signal_connect (G_OBJECT (gam_app->priv->notebook), "switch-page",
+                      G_CALLBACK (gam_app_switch_page_cb), gam_app);
 }
 
 static gboolean
@@ -107,9 +217,138 @@ gam_app_destroy (GtkWidget *widget)
 
     gtk_main_quit ();
 
+    if (gam_app->priv->card_monitor) {
+        g_file_monitor_cancel (gam_app->priv->card_monitor);
+        g_object_unref (gam_app->priv->card_monitor);
+        gam_app->priv->card_monitor = NULL;
+    }
+
+    if (gam_app->priv->unload_timeout_id) {
+        g_source_remove (gam_app->priv->unload_timeout_id);
+        gam_app->priv->unload_timeout_id = 0;
+    }
+
+    g_clear_pointer (&gam_app->priv->pinned, g_hash_table_unref);
+
     gam_app->priv->notebook = NULL;
 }
 
+static void
+gam_app_map (GtkWidget *widget)
+{
+    GamApp * const gam_app = GAM_APP (widget);
+
+    GTK_WIDGET_CLASS (parent_class)->map (widget);
+
+    gam_app_park_mixers (gam_app, NULL);
+}
+
+static void
+gam_app_unmap (GtkWidget *widget)
+{
+    GamApp * const gam_app = GAM_APP (widget);
+
+    GTK_WIDGET_CLASS (parent_class)->unmap (widget);
+
+    gam_app_park_mixers (gam_app, NULL);
+}
+
+static gboolean
+gam_app_window_state_event (GtkWidget *widget, GdkEventWindowState *event)
+{
+    GamApp * const gam_app = GAM_APP (widget);
+
+    if (event->changed_mask & GDK_WINDOW_STATE_ICONIFIED) {
+        gam_app->priv->iconified = (event->new_window_state & GDK_WINDOW_STATE_ICONIFIED) != 0;
+        gam_app_park_mixers (gam_app, NULL);
+    }
+
+    if (GTK_WIDGET_CLASS (parent_class)->window_state_event)
+        return GTK_WIDGET_CLASS (parent_class)->window_state_event (widget, event);
+
+    return FALSE;
+}
+
+/* Ctrl+Z undoes the last change to the card shown, Ctrl+Shift+Z or Ctrl+Y redoes it */
+static gboolean
+gam_app_key_press_event (GtkWidget *widget, GdkEventKey *event)
+{
+    GamApp * const gam_app = GAM_APP (widget);
+    GtkNotebook * const notebook = GTK_NOTEBOOK (gam_app->priv->notebook);
+    GtkWidget *mixer;
+
+    mixer = gam_app_page_get_mixer (gtk_notebook_get_nth_page (notebook, gtk_notebook_get_current_page (notebook)));
+
+    if (mixer != NULL && (event->state & GDK_CONTROL_MASK)) {
+        if (event->keyval == GDK_KEY_z && !(event->state & GDK_SHIFT_MASK)) {
+            gam_mixer_undo (GAM_MIXER (mixer));
+            return TRUE;
+        }
+
+        if (event->keyval == GDK_KEY_Z || event->keyval == GDK_KEY_y ||
+            (event->keyval == GDK_KEY_z && (event->state & GDK_SHIFT_MASK))) {
+            gam_mixer_redo (GAM_MIXER (mixer));
+            return TRUE;
+        }
+    }
+
+    return GTK_WIDGET_CLASS (parent_class)->key_press_event (widget, event);
+}
+
+static void
+gam_app_switch_page_cb (GtkNotebook *notebook,
+                        GtkWidget   *page,
+                        guint        page_num,
+                        GamApp      *gam_app)
+{
+    /* emitted before the notebook changes its current page */
+    gam_app_park_mixers (gam_app, page);
+}
+
+/*
+ * Only the mixer on the current page of a window that is on screen keeps its
+ * widgets up to date; the others are parked until they are shown.
+ * 'current' is the page about to be shown, or NULL for the current one; its
+ * mixer is built if it has not been yet.
+ */
+static void
+gam_app_park_mixers (GamApp *gam_app, GtkWidget *current)
+{
+    GtkNotebook *notebook;
+    gboolean shown;
+    gint64 now;
+    gint i;
+
+    if (gam_app->priv->notebook == NULL)
+        return;
+
+    notebook = GTK_NOTEBOOK (gam_app->priv->notebook);
+
+    if (current == NULL)
+        current = gtk_notebook_get_nth_page (notebook, gtk_notebook_get_current_page (notebook));
+
+    if (current != NULL)
+        gam_app_page_load (gam_app, current);
+
+    shown = gtk_widget_get_mapped (GTK_WIDGET (gam_app)) && !gam_app->priv->iconified;
+    now = g_get_monotonic_time ();
+
+    for (i = 0; i < gtk_notebook_get_n_pages (notebook); i++) {
+        GtkWidget * const page = gtk_notebook_get_nth_page (notebook, i);
+        GamAppPage * const app_page = g_object_get_data (G_OBJECT (page), GAM_APP_PAGE_KEY);
+        const gboolean parked = !shown || page != current;
+
+        if (app_page->mixer == NULL)
+            continue;
+
+        /* the mixer is being hidden */
+        if (parked && !gam_mixer_get_parked (GAM_MIXER (app_page->mixer)))
+            app_page->shown_time = now;
+
+        gam_mixer_set_parked (GAM_MIXER (app_page->mixer), parked);
+    }
+}
+
 static GObject *
 gam_app_constructor (GType                  type,
                      guint                  n_construct_properties,
@@ -118,6 +357,7 @@ gam_app_constructor (GType                  type,
     GObject   *object;
     GamApp    *gam_app;
     GtkWidget *main_box, *button;
+    GFile     *dev_snd;
     gint       index = -1;
 
     object = (* G_OBJECT_CLASS (parent_class)->constructor) (type,
@@ -132,38 +372,21 @@ gam_app_constructor (GType                  type,
                       G_CALLBACK (gam_app_delete), NULL);
 
     while (snd_card_next(&index) == 0 && index >= 0) {
-        GtkWidget *mixer;
-        GtkWidget *label;
-        snd_ctl_t *ctl_handle;
-        gchar     *card;
-        gint       result;
+        gchar *card;
 
         card = g_strdup_printf ("hw:%d", index);
-
-        result = snd_ctl_open (&ctl_handle, card, 0);
-        if (result == 0) {
-            snd_ctl_close(ctl_handle);
-
-            mixer = gam_mixer_new (gam_app, card, "PAN");
-
-            if (gam_mixer_get_visible (GAM_MIXER (mixer)))
-                gtk_widget_show (mixer);
-
-            g_signal_connect (G_OBJECT (mixer), "display_name_changed",
-                              G_CALLBACK (gam_app_mixer_display_name_changed_cb), gam_app);
-
-            g_signal_connect (G_OBJECT (mixer), "visibility_changed",
-                              G_CALLBACK (gam_app_mixer_visibility_changed_cb), gam_app);
-
-            label = gtk_label_new (gam_mixer_get_mixer_name (GAM_MIXER (mixer)));
-            gtk_label_set_justify (GTK_LABEL (label), GTK_JUSTIFY_LEFT);
-
-            gtk_notebook_append_page (GTK_NOTEBOOK (gam_app->priv->notebook), mixer, label);
-        }
-
+        gam_app_add_card (gam_app, card);
         g_free (card);
     }
 
+    /* cards plugged in or out later get a tab of their own, or lose theirs */
+    dev_snd = g_file_new_for_path ("/dev/snd");
+    gam_app->priv->card_monitor = g_file_monitor_directory (dev_snd, G_FILE_MONITOR_NONE, NULL, NULL);
+    if (gam_app->priv->card_monitor)
+        g_signal_connect (G_OBJECT (gam_app->priv->card_monitor), "changed",
+                          G_CALLBACK (gam_app_card_monitor_cb), gam_app);
+    g_object_unref (dev_snd);
+
     // Pack widgets into window
     main_box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
 
@@ -182,49 +405,358 @@ gam_app_constructor (GType                  type,
     return object;
 }
 
+/* the mixer in the other style is built once the card has been opened again */
 static void
 gam_app_switch_mixer_ui (GtkWidget *button,
                          GamApp    *gam_app)
 {
-    GtkWidget *mixer, *label;
-    GtkWidget *old_mixer;
-    snd_ctl_t *ctl_handle;
-    gint   current_page;
-    gint   result;
-    gchar *card;
-    gchar *style;
+    GtkNotebook * const notebook = GTK_NOTEBOOK (gam_app->priv->notebook);
+    GtkWidget *page;
+    GamAppPage *app_page;
+    const gchar *style;
+
+    page = gtk_notebook_get_nth_page (notebook, gtk_notebook_get_current_page (notebook));
+    if (page == NULL)
+        return;
+
+    app_page = g_object_get_data (G_OBJECT (page), GAM_APP_PAGE_KEY);
+    if (app_page->mixer == NULL)
+        return;
+
+    style = g_strcmp0 (app_page->style, "PAN") == 0 ? "DUAL" : "PAN";
+    g_free (app_page->style);
+    app_page->style = g_strdup (style);
+
+    gam_app_page_unload (page);
+    gam_app_page_load (gam_app, page);
+}
+
+static GtkWidget *
+gam_app_new_mixer (GamApp *gam_app, GamCard *card, const gchar *style)
+{
+    GtkWidget *mixer;
+
+    mixer = gam_mixer_new_for_card (gam_app, card, style);
+    if (mixer == NULL)
+        return NULL;
+
+    if (gam_mixer_get_visible (GAM_MIXER (mixer)))
+        gtk_widget_show (mixer);
+
+    g_signal_connect (G_OBJECT (mixer), "display_name_changed",
+                      G_CALLBACK (gam_app_mixer_display_name_changed_cb), gam_app);
+    g_signal_connect (G_OBJECT (mixer), "visibility_changed",
+                      G_CALLBACK (gam_app_mixer_visibility_changed_cb), gam_app);
+    g_signal_connect (G_OBJECT (mixer), "disconnected",
+                      G_CALLBACK (gam_app_mixer_disconnected_cb), gam_app);
+
+    return mixer;
+}
+
+static void
+gam_app_page_free (gpointer data)
+{
+    GamAppPage * const app_page = data;
 
-    current_page = gtk_notebook_get_current_page (GTK_NOTEBOOK (gam_app->priv->notebook));
-    old_mixer = gtk_notebook_get_nth_page (GTK_NOTEBOOK (gam_app->priv->notebook), current_page);
-    g_object_get (G_OBJECT (old_mixer), "card_id", &card, "style", &style, NULL);
+    g_free (app_page->card);
+    g_free (app_page->style);
+    g_free (app_page);
+}
 
-    result = snd_ctl_open (&ctl_handle, card, 0);
-    if (result == 0) {
-        snd_ctl_close(ctl_handle);
+/* the mixer of 'page', or NULL if it has not been built */
+static GtkWidget *
+gam_app_page_get_mixer (GtkWidget *page)
+{
+    GamAppPage *app_page;
 
-        if (g_strcmp0 (style, "PAN") == 0)
-            mixer = gam_mixer_new (gam_app, card, "DUAL");
-        else
-            mixer = gam_mixer_new (gam_app, card, "PAN");
+    if (page == NULL)
+        return NULL;
 
-        if (gam_mixer_get_visible (GAM_MIXER (mixer)))
-            gtk_widget_show_all (mixer);
+    app_page = g_object_get_data (G_OBJECT (page), GAM_APP_PAGE_KEY);
 
-        g_signal_connect (G_OBJECT (mixer), "display_name_changed",
-                          G_CALLBACK (gam_app_mixer_display_name_changed_cb), gam_app);
-        g_signal_connect (G_OBJECT (mixer), "visibility_changed",
-                          G_CALLBACK (gam_app_mixer_visibility_changed_cb), gam_app);
+    return app_page->mixer;
+}
 
-        label = gtk_label_new (gam_mixer_get_mixer_name (GAM_MIXER (mixer)));
-        gtk_label_set_justify (GTK_LABEL (label), GTK_JUSTIFY_LEFT);
+/* the mixer of 'page'; if it has none, its card is opened in the background */
+static GtkWidget *
+gam_app_page_load (GamApp *gam_app, GtkWidget *page)
+{
+    GamAppPage * const app_page = g_object_get_data (G_OBJECT (page), GAM_APP_PAGE_KEY);
+
+    if (app_page->mixer != NULL || app_page->loading)
+        return app_page->mixer;
+
+    app_page->loading = TRUE;
+    gtk_spinner_start (GTK_SPINNER (app_page->spinner));
+    gam_card_load_async (app_page->card, TRUE, gam_app_card_loaded_cb,
+                         g_object_ref (gam_app), g_object_unref);
+
+    return NULL;
+}
 
-        gtk_notebook_insert_page (GTK_NOTEBOOK (gam_app->priv->notebook), mixer, label, current_page);
-        gtk_notebook_set_current_page (GTK_NOTEBOOK (gam_app->priv->notebook), current_page);
-        gtk_notebook_remove_page (GTK_NOTEBOOK (gam_app->priv->notebook), current_page + 1);
+/* destroying the mixer closes its handle; the tab stays as it started */
+static void
+gam_app_page_unload (GtkWidget *page)
+{
+    GamAppPage * const app_page = g_object_get_data (G_OBJECT (page), GAM_APP_PAGE_KEY);
+
+    if (app_page->mixer == NULL)
+        return;
+
+    gtk_widget_destroy (app_page->mixer);
+    app_page->mixer = NULL;
+    gtk_widget_show (app_page->spinner);
+}
+
+/* reads the names of the card of 'page' in the background, for its tab label */
+static void
+gam_app_page_probe (GamApp *gam_app, GtkWidget *page)
+{
+    GamAppPage * const app_page = g_object_get_data (G_OBJECT (page), GAM_APP_PAGE_KEY);
+
+    app_page->probing = TRUE;
+    gam_card_load_async (app_page->card, FALSE, gam_app_card_probed_cb,
+                         g_object_ref (gam_app), g_object_unref);
+}
+
+static void
+gam_app_card_probed_cb (GamCard *card, gpointer data)
+{
+    GamApp * const gam_app = GAM_APP (data);
+    GtkWidget *page;
+    GamAppPage *app_page;
+
+    if (gam_app->priv->notebook == NULL)
+        return;
+
+    page = gam_app_lookup_page (gam_app, card->card_id);
+    if (page == NULL)
+        return;
+
+    app_page = g_object_get_data (G_OBJECT (page), GAM_APP_PAGE_KEY);
+    app_page->probing = FALSE;
+
+    if (card->mixer_name != NULL) {
+        /* a mixer built meanwhile has named the tab already */
+        if (app_page->mixer == NULL)
+            gtk_notebook_set_tab_label_text (GTK_NOTEBOOK (gam_app->priv->notebook), page, card->mixer_name);
+        return;
+    }
+
+    /* the permissions of a card that just appeared may have been set since */
+    if (app_page->probe_again) {
+        app_page->probe_again = FALSE;
+        gam_app_page_probe (gam_app, page);
+        return;
+    }
+
+    if (app_page->mixer == NULL && !app_page->loading)
+        gam_app_remove_card (gam_app, card->card_id);
+}
+
+/* builds the mixer of a card opened in the background, or drops its tab */
+static void
+gam_app_card_loaded_cb (GamCard *card, gpointer data)
+{
+    GamApp * const gam_app = GAM_APP (data);
+    GtkWidget *page;
+    GamAppPage *app_page;
+
+    if (gam_app->priv->notebook == NULL)
+        return;
+
+    page = gam_app_lookup_page (gam_app, card->card_id);
+    if (page == NULL)
+        return;
+
+    app_page = g_object_get_data (G_OBJECT (page), GAM_APP_PAGE_KEY);
+    app_page->loading = FALSE;
+    gtk_spinner_stop (GTK_SPINNER (app_page->spinner));
+
+    if (app_page->mixer != NULL)
+        return;
+
+    if (card->handle != NULL)
+        app_page->mixer = gam_app_new_mixer (gam_app, card, app_page->style);
+
+    if (app_page->mixer == NULL) {
+        if (!app_page->probing)
+            gam_app_remove_card (gam_app, card->card_id);
+        return;
+    }
+
+    app_page->shown_time = g_get_monotonic_time ();
+    gtk_widget_hide (app_page->spinner);
+    gtk_box_pack_start (GTK_BOX (page), app_page->mixer, TRUE, TRUE, 0);
+    gtk_notebook_set_tab_label_text (GTK_NOTEBOOK (gam_app->priv->notebook), page,
+                                     gam_mixer_get_mixer_name (GAM_MIXER (app_page->mixer)));
+
+    gam_app_park_mixers (gam_app, NULL);
+
+    g_signal_emit (G_OBJECT (gam_app), signals[MIXER_LOADED], 0, card->card_id);
+}
+
+static gboolean
+gam_app_unload_pages (gpointer data)
+{
+    GamApp * const gam_app = GAM_APP (data);
+    GtkNotebook *notebook;
+    gint64 now;
+    gint i;
+
+    if (gam_app->priv->notebook == NULL)
+        return G_SOURCE_CONTINUE;
+
+    notebook = GTK_NOTEBOOK (gam_app->priv->notebook);
+    now = g_get_monotonic_time ();
+
+    for (i = 0; i < gtk_notebook_get_n_pages (notebook); i++) {
+        GtkWidget * const page = gtk_notebook_get_nth_page (notebook, i);
+        GamAppPage * const app_page = g_object_get_data (G_OBJECT (page), GAM_APP_PAGE_KEY);
+
+        /* a parked mixer has been hidden since its shown_time; the keys and links keep theirs */
+        if (app_page->mixer != NULL && gam_mixer_get_parked (GAM_MIXER (app_page->mixer)) &&
+            !g_hash_table_contains (gam_app->priv->pinned, app_page->card) &&
+            now - app_page->shown_time >= (gint64) gam_app->priv->unload_time * G_USEC_PER_SEC)
+            gam_app_page_unload (page);
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gint
+gam_app_find_page (GamApp *gam_app, const gchar *card)
+{
+    GtkNotebook * const notebook = GTK_NOTEBOOK (gam_app->priv->notebook);
+    gint i;
+
+    for (i = 0; i < gtk_notebook_get_n_pages (notebook); i++) {
+        GamAppPage * const app_page = g_object_get_data (G_OBJECT (gtk_notebook_get_nth_page (notebook, i)),
+                                                         GAM_APP_PAGE_KEY);
+
+        if (g_strcmp0 (app_page->card, card) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+static GtkWidget *
+gam_app_lookup_page (GamApp *gam_app, const gchar *card)
+{
+    const gint page = gam_app_find_page (gam_app, card);
+
+    if (page < 0)
+        return NULL;
+
+    return gtk_notebook_get_nth_page (GTK_NOTEBOOK (gam_app->priv->notebook), page);
+}
+
+/*
+ * Adds the tab of one card, labelled with its id until its names have been
+ * read; the other tabs are left alone.
+ */
+static void
+gam_app_add_card (GamApp *gam_app, const gchar *card)
+{
+    GtkWidget *page;
+    GtkWidget *label;
+    GamAppPage *app_page;
+
+    page = gam_app_lookup_page (gam_app, card);
+    if (page != NULL) {
+        app_page = g_object_get_data (G_OBJECT (page), GAM_APP_PAGE_KEY);
+        if (app_page->probing)
+            app_page->probe_again = TRUE;
+        return;
+    }
+
+    app_page = g_new0 (GamAppPage, 1);
+    app_page->card = g_strdup (card);
+    app_page->style = g_strdup ("PAN");
+    app_page->spinner = gtk_spinner_new ();
+
+    page = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+    g_object_set_data_full (G_OBJECT (page), GAM_APP_PAGE_KEY, app_page, gam_app_page_free);
+    gtk_box_pack_start (GTK_BOX (page), app_page->spinner, TRUE, TRUE, 0);
+    gtk_widget_show_all (page);
+
+    label = gtk_label_new (card);
+    gtk_label_set_justify (GTK_LABEL (label), GTK_JUSTIFY_LEFT);
+
+    gtk_notebook_append_page (GTK_NOTEBOOK (gam_app->priv->notebook), page, label);
+
+    gam_app_page_probe (gam_app, page);
+    gam_app_park_mixers (gam_app, NULL);
+}
+
+/* closing the tab finalizes the mixer, which removes its handle from polling */
+static void
+gam_app_remove_card (GamApp *gam_app, const gchar *card)
+{
+    const gint page = gam_app_find_page (gam_app, card);
+
+    if (page < 0)
+        return;
+
+    gtk_notebook_remove_page (GTK_NOTEBOOK (gam_app->priv->notebook), page);
+
+    gam_app_park_mixers (gam_app, NULL);
+}
+
+static void
+gam_app_mixer_disconnected_cb (GamMixer *gam_mixer, GamApp *gam_app)
+{
+    gchar *card;
+
+    g_return_if_fail (GAM_IS_APP (gam_app));
+
+    if (gam_app->priv->notebook == NULL)
+        return;
+
+    g_object_get (G_OBJECT (gam_mixer), "card_id", &card, NULL);
+    gam_app_remove_card (gam_app, card);
+    g_free (card);
+}
+
+/* every card has a /dev/snd/controlC<index> */
+static void
+gam_app_card_monitor_cb (GFileMonitor      *monitor,
+                         GFile             *file,
+                         GFile             *other_file,
+                         GFileMonitorEvent  event_type,
+                         GamApp            *gam_app)
+{
+    gchar *basename, *card;
+    gint index;
+    gchar tail;
+
+    if (gam_app->priv->notebook == NULL)
+        return;
+
+    basename = g_file_get_basename (file);
+    if (sscanf (basename, "controlC%d%c", &index, &tail) != 1) {
+        g_free (basename);
+        return;
+    }
+    g_free (basename);
+
+    card = g_strdup_printf ("hw:%d", index);
+
+    switch (event_type) {
+        case G_FILE_MONITOR_EVENT_CREATED:
+        /* the permissions are often only set after the device appeared */
+        case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
+            gam_app_add_card (gam_app, card);
+            break;
+        case G_FILE_MONITOR_EVENT_DELETED:
+            gam_app_remove_card (gam_app, card);
+            break;
+        default:
+            break;
     }
 
     g_free (card);
-    g_free (style);
 }
 
 //static void
@@ -255,17 +787,20 @@ gam_app_mixer_display_name_changed_cb (GamMixer *gam_mixer, GamApp *gam_app)
     g_return_if_fail (GAM_IS_MIXER (gam_mixer));
 
     gtk_notebook_set_tab_label_text (GTK_NOTEBOOK (gam_app->priv->notebook),
-                                     GTK_WIDGET (gam_mixer),
+                                     gtk_widget_get_parent (GTK_WIDGET (gam_mixer)),
                                      gam_mixer_get_display_name (gam_mixer));
 }
 
+/* hides the tab along with the mixer */
 static void
 gam_app_mixer_visibility_changed_cb (GamMixer *gam_mixer)
 {
+    GtkWidget * const page = gtk_widget_get_parent (GTK_WIDGET (gam_mixer));
+
     if (gam_mixer_get_visible (gam_mixer))
-        gtk_widget_show (GTK_WIDGET (gam_mixer));
+        gtk_widget_show (page);
     else
-        gtk_widget_hide (GTK_WIDGET (gam_mixer));
+        gtk_widget_hide (page);
 }
 
 GtkWidget *
@@ -293,4 +828,134 @@ gint
 gam_app_get_slider_toggle_style (void)
 {
     return 1;
-}
\ No newline at end of file
+}
+
+gint
+gam_app_get_volume_curve (void)
+{
+    return volume_curve;
+}
+
+void
+gam_app_set_volume_curve (gint curve)
+{
+    volume_curve = curve;
+}
+
+/*
+ * The mixer of 'card', or NULL if it has no tab or its mixer is not built
+ * yet; asking for it starts opening the card in the background.
+ */
+GtkWidget *
+gam_app_get_mixer (GamApp *gam_app, const gchar *card)
+{
+    gint page;
+
+    g_return_val_if_fail (GAM_IS_APP (gam_app), NULL);
+
+    if (gam_app->priv->notebook == NULL)
+        return NULL;
+
+    page = gam_app_find_page (gam_app, card);
+    if (page < 0)
+        return NULL;
+
+    return gam_app_page_load (gam_app, gtk_notebook_get_nth_page (GTK_NOTEBOOK (gam_app->priv->notebook), page));
+}
+
+/* TRUE while the card of a tab is opened for its mixer */
+gboolean
+gam_app_get_mixer_loading (GamApp *gam_app, const gchar *card)
+{
+    GtkWidget *page;
+
+    g_return_val_if_fail (GAM_IS_APP (gam_app), FALSE);
+
+    if (gam_app->priv->notebook == NULL)
+        return FALSE;
+
+    page = gam_app_lookup_page (gam_app, card);
+    if (page == NULL)
+        return FALSE;
+
+    return ((GamAppPage *) g_object_get_data (G_OBJECT (page), GAM_APP_PAGE_KEY))->loading;
+}
+
+/*
+ * Keeps the mixer of 'card' loaded once it is built, whatever the unload
+ * time; for the ones that write to it without a tab being shown.
+ */
+void
+gam_app_pin_mixer (GamApp *gam_app, const gchar *card)
+{
+    guint pins;
+
+    g_return_if_fail (GAM_IS_APP (gam_app));
+
+    if (gam_app->priv->pinned == NULL)
+        return;
+
+    pins = GPOINTER_TO_UINT (g_hash_table_lookup (gam_app->priv->pinned, card));
+    g_hash_table_insert (gam_app->priv->pinned, g_strdup (card), GUINT_TO_POINTER (pins + 1));
+}
+
+void
+gam_app_unpin_mixer (GamApp *gam_app, const gchar *card)
+{
+    guint pins;
+
+    g_return_if_fail (GAM_IS_APP (gam_app));
+
+    if (gam_app->priv->pinned == NULL)
+        return;
+
+    pins = GPOINTER_TO_UINT (g_hash_table_lookup (gam_app->priv->pinned, card));
+    if (pins > 1)
+        g_hash_table_insert (gam_app->priv->pinned, g_strdup (card), GUINT_TO_POINTER (pins - 1));
+    else
+        g_hash_table_remove (gam_app->priv->pinned, card);
+}
+
+/* the mixers that have been built; free the list with g_list_free() */
+GList *
+gam_app_get_mixers (GamApp *gam_app)
+{
+    GList *pages, *l, *mixers = NULL;
+
+    g_return_val_if_fail (GAM_IS_APP (gam_app), NULL);
+
+    if (gam_app->priv->notebook == NULL)
+        return NULL;
+
+    pages = gtk_container_get_children (GTK_CONTAINER (gam_app->priv->notebook));
+    for (l = pages; l; l = l->next) {
+        GtkWidget * const mixer = gam_app_page_get_mixer (l->data);
+
+        if (mixer != NULL)
+            mixers = g_list_prepend (mixers, mixer);
+    }
+    g_list_free (pages);
+
+    return g_list_reverse (mixers);
+}
+
+/*
+ * Unloads the mixer of a tab that has not been shown for 'seconds', to be
+ * built again when it is; 0 keeps every mixer once it is built.
+ */
+void
+gam_app_set_unload_time (GamApp *gam_app, guint seconds)
+{
+    g_return_if_fail (GAM_IS_APP (gam_app));
+
+    if (gam_app->priv->unload_timeout_id) {
+        g_source_remove (gam_app->priv->unload_timeout_id);
+        gam_app->priv->unload_timeout_id = 0;
+    }
+
+    gam_app->priv->unload_time = seconds;
+
+    if (seconds > 0)
+        gam_app->priv->unload_timeout_id = g_timeout_add_seconds (MAX (seconds / 4, 1),
+                                                                  gam_app_unload_pages, gam_app);
+}
@@ -49,6 +49,8 @@ struct _GamApp
 struct _GamAppClass
 {
     GtkWindowClass parent_class;
+
+    void (* mixer_loaded) (GamApp *gam_app, const gchar *card);
 };
 
 GType       gam_app_get_type                (void) G_GNUC_CONST;
@@ -56,6 +58,19 @@ GtkWidget  *gam_app_new                     (void);
 void        gam_app_run                     (GamApp *gam_app);
 gint        gam_app_get_mixer_slider_style  (void);
 gint        gam_app_get_slider_toggle_style (void);
+gint        gam_app_get_volume_curve        (void);
+void        gam_app_set_volume_curve        (gint    curve);
+GList      *gam_app_get_mixers              (GamApp *gam_app);
+GtkWidget  *gam_app_get_mixer               (GamApp      *gam_app,
+                                             const gchar *card);
+gboolean    gam_app_get_mixer_loading       (GamApp      *gam_app,
+                                             const gchar *card);
+void        gam_app_pin_mixer               (GamApp      *gam_app,
+                                             const gchar *card);
+void        gam_app_unpin_mixer             (GamApp      *gam_app,
+                                             const gchar *card);
+void        gam_app_set_unload_time         (GamApp      *gam_app,
+                                             guint        seconds);
 
 G_END_DECLS
 
@@ -0,0 +1,184 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gam-card.h"
+
+/* cards probed at the same time; slow USB devices mostly wait on the bus */
+#define GAM_CARD_LOAD_THREADS 8
+
+typedef struct
+{
+    GamCard        *card;
+    gboolean        open_mixer;
+    GamCardFunc     func;
+    gpointer        data;
+    GDestroyNotify  destroy;
+} GamCardLoad;
+
+static GThreadPool *load_pool = NULL;
+
+gboolean
+gam_card_get_names (const gchar *card_id, gchar **card_name, gchar **mixer_name)
+{
+    snd_ctl_card_info_t *hw_info;
+    snd_ctl_t *ctl_handle;
+    gint err;
+
+    g_return_val_if_fail (card_id != NULL, FALSE);
+
+    snd_ctl_card_info_alloca (&hw_info);
+
+    err = snd_ctl_open (&ctl_handle, card_id, 0);
+    if (err != 0) return FALSE;
+
+    err = snd_ctl_card_info (ctl_handle, hw_info);
+    snd_ctl_close (ctl_handle);
+    if (err != 0) return FALSE;
+
+    if (card_name)
+        *card_name = g_strdup (snd_ctl_card_info_get_name (hw_info));
+    if (mixer_name)
+        *mixer_name = g_strdup (snd_ctl_card_info_get_mixername (hw_info));
+
+    return TRUE;
+}
+
+snd_mixer_t *
+gam_card_open (const gchar *card_id, gchar **card_name, gchar **mixer_name)
+{
+    snd_mixer_t *handle;
+    gchar *names[2] = { NULL, NULL };
+    gint err;
+
+    g_return_val_if_fail (card_id != NULL, NULL);
+
+    if (!gam_card_get_names (card_id, &names[0], &names[1]))
+        return NULL;
+
+    err = snd_mixer_open (&handle, 0);
+    if (err == 0) {
+        err = snd_mixer_attach (handle, card_id);
+        if (err == 0)
+            err = snd_mixer_selem_register (handle, NULL, NULL);
+        if (err == 0)
+            err = snd_mixer_load (handle);
+        if (err != 0)
+            snd_mixer_close (handle);
+    }
+
+    if (err != 0) {
+        g_free (names[0]);
+        g_free (names[1]);
+        return NULL;
+    }
+
+    if (card_name)
+        *card_name = names[0];
+    else
+        g_free (names[0]);
+
+    if (mixer_name)
+        *mixer_name = names[1];
+    else
+        g_free (names[1]);
+
+    return handle;
+}
+
+void
+gam_card_close (snd_mixer_t *handle)
+{
+    if (handle)
+        snd_mixer_close (handle);
+}
+
+void
+gam_card_free (GamCard *card)
+{
+    if (card == NULL)
+        return;
+
+    gam_card_close (card->handle);
+    g_free (card->card_id);
+    g_free (card->card_name);
+    g_free (card->mixer_name);
+    g_free (card);
+}
+
+static gboolean
+gam_card_load_done (gpointer data)
+{
+    GamCardLoad * const load = data;
+
+    load->func (load->card, load->data);
+
+    gam_card_free (load->card);
+    if (load->destroy)
+        load->destroy (load->data);
+    g_free (load);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* runs on a worker of the pool, one card at a time */
+static void
+gam_card_load_run (gpointer data, gpointer user_data)
+{
+    GamCardLoad * const load = data;
+    GamCard * const card = load->card;
+
+    if (load->open_mixer)
+        card->handle = gam_card_open (card->card_id, &card->card_name, &card->mixer_name);
+    else
+        gam_card_get_names (card->card_id, &card->card_name, &card->mixer_name);
+
+    g_idle_add_full (G_PRIORITY_DEFAULT, gam_card_load_done, load, NULL);
+}
+
+void
+gam_card_load_async (const gchar    *card_id,
+                     gboolean        open_mixer,
+                     GamCardFunc     func,
+                     gpointer        data,
+                     GDestroyNotify  destroy)
+{
+    GamCardLoad *load;
+
+    g_return_if_fail (card_id != NULL);
+    g_return_if_fail (func != NULL);
+
+    if (load_pool == NULL)
+        load_pool = g_thread_pool_new (gam_card_load_run, NULL, GAM_CARD_LOAD_THREADS, FALSE, NULL);
+
+    load = g_new (GamCardLoad, 1);
+    load->card = g_new0 (GamCard, 1);
+    load->card->card_id = g_strdup (card_id);
+    load->open_mixer = open_mixer;
+    load->func = func;
+    load->data = data;
+    load->destroy = destroy;
+
+    g_thread_pool_push (load_pool, load, NULL);
+}
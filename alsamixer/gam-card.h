@@ -0,0 +1,81 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_CARD_H__
+#define __GAM_CARD_H__
+
+#include <alsa/asoundlib.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Reads the names of 'card_id' from its control device, without loading
+ * its mixer.  Returns FALSE if the card cannot be opened.
+ */
+gboolean     gam_card_get_names (const gchar  *card_id,
+                                 gchar       **card_name,
+                                 gchar       **mixer_name);
+
+/*
+ * Opens the simple mixer of 'card_id' and loads its elements.  On success
+ * the card and mixer names are returned in newly allocated strings; on
+ * failure NULL is returned and nothing is left open.  Safe to call from any
+ * thread.
+ */
+snd_mixer_t *gam_card_open      (const gchar  *card_id,
+                                 gchar       **card_name,
+                                 gchar       **mixer_name);
+void         gam_card_close     (snd_mixer_t  *handle);
+
+/*
+ * A card probed or opened by gam_card_load_async().  Whoever takes over
+ * the handle or a name sets the field to NULL; gam_card_free() closes and
+ * frees what is left.
+ */
+typedef struct
+{
+    gchar       *card_id;
+    /* NULL if the card could not be opened, or was only probed */
+    snd_mixer_t *handle;
+    /* NULL if the card could not be probed */
+    gchar       *card_name;
+    gchar       *mixer_name;
+} GamCard;
+
+typedef void (* GamCardFunc) (GamCard  *card,
+                              gpointer  data);
+
+/*
+ * Probes 'card_id' on a worker thread, and also opens its mixer if
+ * 'open_mixer' is set.  'func' gets the result in the main loop; the card
+ * is freed when it returns, and 'data' is destroyed with 'destroy'.
+ */
+void         gam_card_load_async (const gchar    *card_id,
+                                  gboolean        open_mixer,
+                                  GamCardFunc     func,
+                                  gpointer        data,
+                                  GDestroyNotify  destroy);
+void         gam_card_free       (GamCard        *card);
+
+G_END_DECLS
+
+#endif /* __GAM_CARD_H__ */
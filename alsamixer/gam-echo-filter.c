@@ -0,0 +1,61 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "gam-echo-filter.h"
+
+void
+gam_echo_filter_init (GamEchoFilter *filter)
+{
+    memset (filter, 0, sizeof (*filter));
+}
+
+/* 'state' is what the element holds once the write is done */
+void
+gam_echo_filter_arm (GamEchoFilter *filter, const GamEchoState *state)
+{
+    filter->written = *state;
+    filter->armed = TRUE;
+}
+
+/*
+ * TRUE if a value event that finds the element in 'state' only echoes the
+ * last write.  The first event that finds anything else disarms the filter,
+ * so every event after an outside change reaches the views.
+ */
+gboolean
+gam_echo_filter_check (GamEchoFilter *filter, const GamEchoState *state)
+{
+    if (!filter->armed)
+        return FALSE;
+
+    if (memcmp (state, &filter->written, sizeof (*state)) == 0)
+        return TRUE;
+
+    filter->armed = FALSE;
+
+    return FALSE;
+}
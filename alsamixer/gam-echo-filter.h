@@ -0,0 +1,60 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_ECHO_FILTER_H__
+#define __GAM_ECHO_FILTER_H__
+
+#include <glib.h>
+#include <alsa/asoundlib.h>
+
+G_BEGIN_DECLS
+
+#define GAM_ECHO_FILTER_MAX_CHANNELS (SND_MIXER_SCHN_LAST + 1)
+
+/*
+ * Recognises the value events that only echo our own writes.  A write arms
+ * the filter with what the element holds right after it; the events that
+ * follow are echoes for as long as the element still holds exactly that.
+ * One write may cause several events, e.g. one per channel it sets, so the
+ * snapshot stays armed until an event finds the element changed.  Arm and
+ * check with the mixer handle locked.
+ */
+typedef struct
+{
+    glong volume[2][GAM_ECHO_FILTER_MAX_CHANNELS];
+    gint  switches[2][GAM_ECHO_FILTER_MAX_CHANNELS];
+} GamEchoState;
+
+typedef struct
+{
+    GamEchoState written;
+    gboolean     armed;
+} GamEchoFilter;
+
+void     gam_echo_filter_init  (GamEchoFilter      *filter);
+void     gam_echo_filter_arm   (GamEchoFilter      *filter,
+                                const GamEchoState *state);
+gboolean gam_echo_filter_check (GamEchoFilter      *filter,
+                                const GamEchoState *state);
+
+G_END_DECLS
+
+#endif /* __GAM_ECHO_FILTER_H__ */
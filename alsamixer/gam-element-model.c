@@ -0,0 +1,609 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <math.h>
+
+#include "gam-element-model.h"
+
+enum {
+    VOLUME_CHANGED,
+    SWITCH_CHANGED,
+    LAST_SIGNAL
+};
+
+typedef struct
+{
+    gboolean present;
+    gdouble  raw;
+    gdouble  dB;
+    gdouble  normalized;
+    gboolean on;
+
+    /* the exact volume a view asked for, the step it rounds to and how close
+     * the hardware must be to that step to count as on it; -1 if none
+     */
+    gdouble  requested;
+    gdouble  requested_step;
+    gdouble  tolerance;
+} GamElementChannel;
+
+struct _GamElementModelPrivate
+{
+    /* updates come from where the events are handled, reads from the views */
+    GMutex                 lock;
+
+    const GamElementInfo  *info;
+    struct volume_mapping *mapping[2];
+    GamElementChannel      channels[2][VOLUME_MAPPING_MAX_CHANNELS];
+
+    /* channels that changed since the views were last told, per direction */
+    guint                  volume_changed[2];
+    guint                  switch_changed[2];
+};
+
+static int (* const get_volume[2])(snd_mixer_elem_t *, snd_mixer_selem_channel_id_t, long *) = {
+    snd_mixer_selem_get_playback_volume,
+    snd_mixer_selem_get_capture_volume,
+};
+
+static int (* const get_dB[2])(snd_mixer_elem_t *, snd_mixer_selem_channel_id_t, long *) = {
+    snd_mixer_selem_get_playback_dB,
+    snd_mixer_selem_get_capture_dB,
+};
+
+static int (* const get_switch[2])(snd_mixer_elem_t *, snd_mixer_selem_channel_id_t, int *) = {
+    snd_mixer_selem_get_playback_switch,
+    snd_mixer_selem_get_capture_switch,
+};
+
+/* how far a read back volume may be from the step it was rounded to */
+#define GAM_ELEMENT_MODEL_EPSILON   1e-9
+/* the same for a range too fine for a table, whose steps are only known to ALSA */
+#define GAM_ELEMENT_MODEL_FINE_STEP 1e-3
+
+static void gam_element_model_finalize (GObject *object);
+
+static gpointer parent_class;
+static guint signals[LAST_SIGNAL] = { 0 };
+
+G_DEFINE_TYPE_WITH_CODE (GamElementModel, gam_element_model, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (GamElementModel))
+
+static void
+gam_element_model_class_init (GamElementModelClass *klass)
+{
+    GObjectClass * const gobject_class = G_OBJECT_CLASS (klass);
+
+    parent_class = g_type_class_peek_parent (klass);
+
+    gobject_class->finalize = gam_element_model_finalize;
+
+    signals[VOLUME_CHANGED] =
+        g_signal_new ("volume_changed",
+                      G_OBJECT_CLASS_TYPE (gobject_class),
+                      G_SIGNAL_RUN_FIRST,
+                      G_STRUCT_OFFSET (GamElementModelClass, volume_changed),
+                      NULL, NULL, NULL,
+                      G_TYPE_NONE, 2, G_TYPE_INT, G_TYPE_UINT);
+
+    signals[SWITCH_CHANGED] =
+        g_signal_new ("switch_changed",
+                      G_OBJECT_CLASS_TYPE (gobject_class),
+                      G_SIGNAL_RUN_FIRST,
+                      G_STRUCT_OFFSET (GamElementModelClass, switch_changed),
+                      NULL, NULL, NULL,
+                      G_TYPE_NONE, 2, G_TYPE_INT, G_TYPE_UINT);
+}
+
+static void
+gam_element_model_init (GamElementModel *model)
+{
+    guint dir, channel;
+
+    model->priv = gam_element_model_get_instance_private (model);
+
+    g_mutex_init (&model->priv->lock);
+    model->priv->info = NULL;
+    model->priv->mapping[PLAYBACK] = NULL;
+    model->priv->mapping[CAPTURE] = NULL;
+    model->priv->volume_changed[PLAYBACK] = 0;
+    model->priv->volume_changed[CAPTURE] = 0;
+    model->priv->switch_changed[PLAYBACK] = 0;
+    model->priv->switch_changed[CAPTURE] = 0;
+
+    for (dir = 0; dir < 2; dir++) {
+        for (channel = 0; channel < VOLUME_MAPPING_MAX_CHANNELS; channel++) {
+            GamElementChannel * const c = &model->priv->channels[dir][channel];
+
+            c->present = FALSE;
+            c->raw = 0;
+            c->dB = NAN;
+            c->normalized = 0;
+            c->on = FALSE;
+            c->requested = -1;
+            c->requested_step = -1;
+            c->tolerance = 0;
+        }
+    }
+}
+
+/* the mappings go last, a write that holds a reference may still use them */
+static void
+gam_element_model_finalize (GObject *object)
+{
+    GamElementModel * const model = GAM_ELEMENT_MODEL (object);
+    guint dir;
+
+    gam_element_model_detach (model);
+
+    for (dir = 0; dir < 2; dir++) {
+        if (model->priv->mapping[dir])
+            volume_mapping_free (model->priv->mapping[dir]);
+        model->priv->mapping[dir] = NULL;
+    }
+
+    g_mutex_clear (&model->priv->lock);
+
+    G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+/*
+ * The cached state of one simple element, in both directions.  The mixer
+ * applies every event of the element here once, and the views read from it
+ * instead of from ALSA; a volume a view wrote is kept as the double it asked
+ * for, for as long as the hardware stays on the step that double rounds to.
+ * The model also holds the one volume mapping of each direction, which all
+ * views and writes of the element share.  'info' is the registry entry of
+ * the element, read until the model is detached.
+ */
+GamElementModel *
+gam_element_model_new (const GamElementInfo *info, enum volume_mapping_curve curve)
+{
+    GamElementModel *model;
+    guint dir;
+
+    g_return_val_if_fail (info != NULL && info->elem != NULL, NULL);
+
+    model = g_object_new (GAM_TYPE_ELEMENT_MODEL, NULL);
+    model->priv->info = info;
+
+    for (dir = 0; dir < 2; dir++) {
+        if (info->has_volume[dir])
+            model->priv->mapping[dir] = volume_mapping_new (info->elem, dir, curve);
+    }
+
+    /* the views read what there is when they are built; called with the handle locked */
+    gam_element_model_update (model, SND_CTL_EVENT_MASK_VALUE);
+    for (dir = 0; dir < 2; dir++) {
+        model->priv->volume_changed[dir] = 0;
+        model->priv->switch_changed[dir] = 0;
+    }
+
+    return model;
+}
+
+/*
+ * Rereads the element from its cache, with the SND_CTL_EVENT_MASK_* bits of
+ * its events.  What changed is only noted; gam_element_model_flush() tells
+ * the views.  Runs wherever the events are handled, with the mixer handle
+ * locked; a changed range reloads the mappings here, so that the views never
+ * have to read the element.
+ */
+void
+gam_element_model_update (GamElementModel *model, guint mask)
+{
+    const GamElementInfo *info;
+    snd_mixer_elem_t *elem;
+    guint * const volume_changed = model->priv->volume_changed;
+    guint * const switch_changed = model->priv->switch_changed;
+    guint dir;
+
+    g_return_if_fail (GAM_IS_ELEMENT_MODEL (model));
+
+    g_mutex_lock (&model->priv->lock);
+
+    info = model->priv->info;
+    if (info == NULL || info->elem == NULL || mask == SND_CTL_EVENT_MASK_REMOVE) {
+        g_mutex_unlock (&model->priv->lock);
+        return;
+    }
+
+    elem = info->elem;
+
+    for (dir = 0; dir < 2; dir++) {
+        snd_mixer_selem_channel_id_t present[VOLUME_MAPPING_MAX_CHANNELS];
+        gdouble normalized[VOLUME_MAPPING_MAX_CHANNELS];
+        guint count = 0, channel, i;
+
+        for (channel = 0; channel < VOLUME_MAPPING_MAX_CHANNELS; channel++) {
+            GamElementChannel * const c = &model->priv->channels[dir][channel];
+            const gboolean was_present = c->present;
+
+            c->present = (info->channels[dir] & (1u << channel)) != 0;
+            if (c->present != was_present) {
+                volume_changed[dir] |= 1 << channel;
+                switch_changed[dir] |= 1 << channel;
+            }
+
+            if (c->present)
+                present[count++] = channel;
+        }
+
+        /* the ranges or dB information changed, the mapping reloads below; old requests mean nothing now */
+        if ((mask & SND_CTL_EVENT_MASK_INFO) && model->priv->mapping[dir]) {
+            volume_mapping_invalidate (model->priv->mapping[dir]);
+            for (i = 0; i < count; i++)
+                model->priv->channels[dir][present[i]].requested = -1;
+        }
+
+        if (model->priv->mapping[dir])
+            volume_mapping_get_normalized_n (model->priv->mapping[dir], present, normalized, count);
+
+        for (i = 0; i < count; i++) {
+            GamElementChannel * const c = &model->priv->channels[dir][present[i]];
+            long value;
+            int on;
+
+            if (model->priv->mapping[dir]) {
+                get_volume[dir] (elem, present[i], &value);
+                if (c->raw != value || c->normalized != normalized[i])
+                    volume_changed[dir] |= 1 << present[i];
+                c->raw = value;
+                c->normalized = normalized[i];
+                c->dB = get_dB[dir] (elem, present[i], &value) < 0 ? NAN : value / 100.0;
+            }
+
+            if (info->has_switch[dir]) {
+                get_switch[dir] (elem, present[i], &on);
+                if (c->on != (on != 0))
+                    switch_changed[dir] |= 1 << present[i];
+                c->on = on != 0;
+            }
+        }
+    }
+
+    g_mutex_unlock (&model->priv->lock);
+}
+
+/*
+ * Takes the raw volumes and switches a write of ours left in the element,
+ * as read back with the mixer handle locked.  The value events that echo
+ * the write are dropped before they get here, so only the channels that
+ * moved are mapped again, once per write instead of once per event.
+ */
+void
+gam_element_model_seed (GamElementModel *model,
+                        const glong      volume[2][VOLUME_MAPPING_MAX_CHANNELS],
+                        const gint       switches[2][VOLUME_MAPPING_MAX_CHANNELS])
+{
+    const GamElementInfo *info;
+    guint dir, channel;
+    long value;
+
+    g_return_if_fail (GAM_IS_ELEMENT_MODEL (model));
+
+    g_mutex_lock (&model->priv->lock);
+
+    info = model->priv->info;
+    if (info == NULL || info->elem == NULL) {
+        g_mutex_unlock (&model->priv->lock);
+        return;
+    }
+
+    for (dir = 0; dir < 2; dir++) {
+        for (channel = 0; channel < VOLUME_MAPPING_MAX_CHANNELS; channel++) {
+            GamElementChannel * const c = &model->priv->channels[dir][channel];
+
+            if (!c->present)
+                continue;
+
+            if (model->priv->mapping[dir] && c->raw != volume[dir][channel]) {
+                c->raw = volume[dir][channel];
+                c->normalized = volume_mapping_get_normalized (model->priv->mapping[dir], channel);
+                c->dB = get_dB[dir] (info->elem, channel, &value) < 0 ? NAN : value / 100.0;
+                model->priv->volume_changed[dir] |= 1 << channel;
+            }
+
+            if (info->has_switch[dir] && c->on != (switches[dir][channel] != 0)) {
+                c->on = switches[dir][channel] != 0;
+                model->priv->switch_changed[dir] |= 1 << channel;
+            }
+        }
+    }
+
+    g_mutex_unlock (&model->priv->lock);
+}
+
+/* emits the changes noted since the last time, a signal per kind and direction */
+void
+gam_element_model_flush (GamElementModel *model)
+{
+    guint volume_changed[2], switch_changed[2];
+    guint dir;
+
+    g_return_if_fail (GAM_IS_ELEMENT_MODEL (model));
+
+    /* a handler may read the model, and so see it as it is now */
+    g_mutex_lock (&model->priv->lock);
+    for (dir = 0; dir < 2; dir++) {
+        volume_changed[dir] = model->priv->volume_changed[dir];
+        switch_changed[dir] = model->priv->switch_changed[dir];
+        model->priv->volume_changed[dir] = 0;
+        model->priv->switch_changed[dir] = 0;
+    }
+    g_mutex_unlock (&model->priv->lock);
+
+    for (dir = 0; dir < 2; dir++) {
+        if (volume_changed[dir])
+            g_signal_emit (G_OBJECT (model), signals[VOLUME_CHANGED], 0, dir, volume_changed[dir]);
+        if (switch_changed[dir])
+            g_signal_emit (G_OBJECT (model), signals[SWITCH_CHANGED], 0, dir, switch_changed[dir]);
+    }
+}
+
+/* the element is going away; the cache stays readable, but is no longer updated */
+void
+gam_element_model_detach (GamElementModel *model)
+{
+    g_return_if_fail (GAM_IS_ELEMENT_MODEL (model));
+
+    g_mutex_lock (&model->priv->lock);
+    model->priv->info = NULL;
+    g_mutex_unlock (&model->priv->lock);
+}
+
+/*
+ * The mapping of direction 'dir'; NULL if the element has no volume there.
+ * Only for writes, which use it with the mixer handle locked.
+ */
+struct volume_mapping *
+gam_element_model_get_mapping (GamElementModel *model, enum ctl_dir dir)
+{
+    g_return_val_if_fail (GAM_IS_ELEMENT_MODEL (model), NULL);
+
+    return model->priv->mapping[dir];
+}
+
+/* fills 'channels' with the channels of direction 'dir', in ALSA order; returns their number */
+guint
+gam_element_model_get_channels (GamElementModel              *model,
+                                enum ctl_dir                  dir,
+                                snd_mixer_selem_channel_id_t *channels)
+{
+    guint count = 0, channel;
+
+    g_return_val_if_fail (GAM_IS_ELEMENT_MODEL (model), 0);
+
+    g_mutex_lock (&model->priv->lock);
+    for (channel = 0; channel < VOLUME_MAPPING_MAX_CHANNELS; channel++)
+        if (model->priv->channels[dir][channel].present)
+            channels[count++] = channel;
+    g_mutex_unlock (&model->priv->lock);
+
+    return count;
+}
+
+/* the hardware step next to 'volume', towards 'delta' (-1/1) */
+gdouble
+gam_element_model_step (GamElementModel *model,
+                        enum ctl_dir     dir,
+                        gdouble          volume,
+                        gint             delta)
+{
+    g_return_val_if_fail (GAM_IS_ELEMENT_MODEL (model), volume);
+
+    g_mutex_lock (&model->priv->lock);
+    if (model->priv->info != NULL && model->priv->mapping[dir] != NULL)
+        volume = volume_mapping_step (model->priv->mapping[dir], volume, delta);
+    g_mutex_unlock (&model->priv->lock);
+
+    return volume;
+}
+
+/* the hardware step a write of 'volume' ends up on */
+gdouble
+gam_element_model_quantize (GamElementModel *model,
+                            enum ctl_dir     dir,
+                            gdouble          volume,
+                            gint             round)
+{
+    g_return_val_if_fail (GAM_IS_ELEMENT_MODEL (model), volume);
+
+    g_mutex_lock (&model->priv->lock);
+    if (model->priv->info != NULL && model->priv->mapping[dir] != NULL)
+        volume = volume_mapping_quantize (model->priv->mapping[dir], volume, round);
+    g_mutex_unlock (&model->priv->lock);
+
+    return volume;
+}
+
+/* the gain 'volume' is written as, in 1/100 dB */
+gint
+gam_element_model_to_dB (GamElementModel *model,
+                         enum ctl_dir     dir,
+                         gdouble          volume,
+                         gint             round,
+                         glong           *dB)
+{
+    gint err = -ENODEV;
+
+    g_return_val_if_fail (GAM_IS_ELEMENT_MODEL (model), -EINVAL);
+
+    g_mutex_lock (&model->priv->lock);
+    if (model->priv->info != NULL && model->priv->mapping[dir] != NULL)
+        err = volume_mapping_to_dB (model->priv->mapping[dir], volume, round, dB);
+    g_mutex_unlock (&model->priv->lock);
+
+    return err;
+}
+
+gboolean
+gam_element_model_has_channel (GamElementModel              *model,
+                               enum ctl_dir                  dir,
+                               snd_mixer_selem_channel_id_t  channel)
+{
+    g_return_val_if_fail (GAM_IS_ELEMENT_MODEL (model), FALSE);
+    g_return_val_if_fail (channel < VOLUME_MAPPING_MAX_CHANNELS, FALSE);
+
+    gboolean value;
+
+    g_mutex_lock (&model->priv->lock);
+    value = model->priv->channels[dir][channel].present;
+    g_mutex_unlock (&model->priv->lock);
+
+    return value;
+}
+
+gdouble
+gam_element_model_get_raw (GamElementModel              *model,
+                           enum ctl_dir                  dir,
+                           snd_mixer_selem_channel_id_t  channel)
+{
+    g_return_val_if_fail (GAM_IS_ELEMENT_MODEL (model), 0);
+    g_return_val_if_fail (channel < VOLUME_MAPPING_MAX_CHANNELS, 0);
+
+    gdouble value;
+
+    g_mutex_lock (&model->priv->lock);
+    value = model->priv->channels[dir][channel].raw;
+    g_mutex_unlock (&model->priv->lock);
+
+    return value;
+}
+
+/* in dB; NAN without dB information */
+gdouble
+gam_element_model_get_dB (GamElementModel              *model,
+                          enum ctl_dir                  dir,
+                          snd_mixer_selem_channel_id_t  channel)
+{
+    g_return_val_if_fail (GAM_IS_ELEMENT_MODEL (model), NAN);
+    g_return_val_if_fail (channel < VOLUME_MAPPING_MAX_CHANNELS, NAN);
+
+    gdouble value;
+
+    g_mutex_lock (&model->priv->lock);
+    value = model->priv->channels[dir][channel].dB;
+    g_mutex_unlock (&model->priv->lock);
+
+    return value;
+}
+
+gdouble
+gam_element_model_get_normalized (GamElementModel              *model,
+                                  enum ctl_dir                  dir,
+                                  snd_mixer_selem_channel_id_t  channel)
+{
+    const GamElementChannel *c;
+    gdouble value;
+
+    g_return_val_if_fail (GAM_IS_ELEMENT_MODEL (model), 0);
+    g_return_val_if_fail (channel < VOLUME_MAPPING_MAX_CHANNELS, 0);
+
+    g_mutex_lock (&model->priv->lock);
+
+    c = &model->priv->channels[dir][channel];
+
+    if (c->requested >= 0 && fabs (c->normalized - c->requested_step) < c->tolerance)
+        value = c->requested;
+    else
+        value = c->normalized;
+
+    g_mutex_unlock (&model->priv->lock);
+
+    return value;
+}
+
+void
+gam_element_model_get_normalized_n (GamElementModel                    *model,
+                                    enum ctl_dir                        dir,
+                                    const snd_mixer_selem_channel_id_t *channels,
+                                    gdouble                            *volumes,
+                                    guint                               count)
+{
+    guint i;
+
+    for (i = 0; i < count; i++)
+        volumes[i] = gam_element_model_get_normalized (model, dir, channels[i]);
+}
+
+gboolean
+gam_element_model_get_switch (GamElementModel              *model,
+                              enum ctl_dir                  dir,
+                              snd_mixer_selem_channel_id_t  channel)
+{
+    g_return_val_if_fail (GAM_IS_ELEMENT_MODEL (model), FALSE);
+    g_return_val_if_fail (channel < VOLUME_MAPPING_MAX_CHANNELS, FALSE);
+
+    gboolean value;
+
+    g_mutex_lock (&model->priv->lock);
+    value = model->priv->channels[dir][channel].on;
+    g_mutex_unlock (&model->priv->lock);
+
+    return value;
+}
+
+/*
+ * Views call this with the volumes they hand to the writer, rounded in
+ * the direction 'round' as the writer will.  Once the hardware reports the
+ * step they round to, the model answers with the exact volumes instead.
+ */
+void
+gam_element_model_request (GamElementModel                    *model,
+                           enum ctl_dir                        dir,
+                           const snd_mixer_selem_channel_id_t *channels,
+                           const gdouble                      *volumes,
+                           guint                               count,
+                           gint                                round)
+{
+    gdouble tolerance;
+    long steps;
+    guint i;
+
+    g_return_if_fail (GAM_IS_ELEMENT_MODEL (model));
+
+    g_mutex_lock (&model->priv->lock);
+
+    if (model->priv->info == NULL || model->priv->mapping[dir] == NULL) {
+        g_mutex_unlock (&model->priv->lock);
+        return;
+    }
+
+    /* a mapping that knows its steps reads back exactly the step it rounds to */
+    steps = volume_mapping_get_steps (model->priv->mapping[dir]);
+    tolerance = steps > 0 ? GAM_ELEMENT_MODEL_EPSILON : GAM_ELEMENT_MODEL_FINE_STEP;
+
+    for (i = 0; i < count; i++) {
+        GamElementChannel * const c = &model->priv->channels[dir][channels[i]];
+
+        c->requested = volumes[i];
+        c->requested_step = volume_mapping_quantize (model->priv->mapping[dir], volumes[i], round);
+        c->tolerance = tolerance;
+    }
+
+    g_mutex_unlock (&model->priv->lock);
+}
@@ -0,0 +1,120 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_ELEMENT_MODEL_H__
+#define __GAM_ELEMENT_MODEL_H__
+
+#include <alsa/asoundlib.h>
+#include <glib-object.h>
+#include <alsamixer/volume_mapping.h>
+#include <alsamixer/gam-element-registry.h>
+
+G_BEGIN_DECLS
+
+#define GAM_TYPE_ELEMENT_MODEL            (gam_element_model_get_type ())
+#define GAM_ELEMENT_MODEL(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GAM_TYPE_ELEMENT_MODEL, GamElementModel))
+#define GAM_ELEMENT_MODEL_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GAM_TYPE_ELEMENT_MODEL, GamElementModelClass))
+#define GAM_IS_ELEMENT_MODEL(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GAM_TYPE_ELEMENT_MODEL))
+#define GAM_IS_ELEMENT_MODEL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GAM_TYPE_ELEMENT_MODEL))
+#define GAM_ELEMENT_MODEL_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GAM_TYPE_ELEMENT_MODEL, GamElementModelClass))
+
+typedef struct _GamElementModelPrivate GamElementModelPrivate;
+typedef struct _GamElementModel GamElementModel;
+typedef struct _GamElementModelClass GamElementModelClass;
+
+struct _GamElementModel
+{
+    GObject parent_instance;
+
+    GamElementModelPrivate *priv;
+};
+
+/* 'dir' is an enum ctl_dir, 'channels' a bit per channel that changed */
+struct _GamElementModelClass
+{
+    GObjectClass parent_class;
+
+    void (* volume_changed) (GamElementModel *model,
+                             gint             dir,
+                             guint            channels);
+    void (* switch_changed) (GamElementModel *model,
+                             gint             dir,
+                             guint            channels);
+};
+
+GType                 gam_element_model_get_type       (void) G_GNUC_CONST;
+GamElementModel      *gam_element_model_new            (const GamElementInfo *info,
+                                                        enum volume_mapping_curve curve);
+void                  gam_element_model_update         (GamElementModel  *model,
+                                                        guint             mask);
+void                  gam_element_model_seed           (GamElementModel  *model,
+                                                        const glong       volume[2][VOLUME_MAPPING_MAX_CHANNELS],
+                                                        const gint        switches[2][VOLUME_MAPPING_MAX_CHANNELS]);
+void                  gam_element_model_flush          (GamElementModel  *model);
+void                  gam_element_model_detach         (GamElementModel  *model);
+struct volume_mapping *gam_element_model_get_mapping   (GamElementModel  *model,
+                                                        enum ctl_dir      dir);
+guint                 gam_element_model_get_channels   (GamElementModel  *model,
+                                                        enum ctl_dir      dir,
+                                                        snd_mixer_selem_channel_id_t *channels);
+gdouble               gam_element_model_step           (GamElementModel  *model,
+                                                        enum ctl_dir      dir,
+                                                        gdouble           volume,
+                                                        gint              delta);
+gdouble               gam_element_model_quantize       (GamElementModel  *model,
+                                                        enum ctl_dir      dir,
+                                                        gdouble           volume,
+                                                        gint              round);
+gint                  gam_element_model_to_dB          (GamElementModel  *model,
+                                                        enum ctl_dir      dir,
+                                                        gdouble           volume,
+                                                        gint              round,
+                                                        glong            *dB);
+gboolean              gam_element_model_has_channel    (GamElementModel  *model,
+                                                        enum ctl_dir      dir,
+                                                        snd_mixer_selem_channel_id_t channel);
+gdouble               gam_element_model_get_raw        (GamElementModel  *model,
+                                                        enum ctl_dir      dir,
+                                                        snd_mixer_selem_channel_id_t channel);
+gdouble               gam_element_model_get_dB         (GamElementModel  *model,
+                                                        enum ctl_dir      dir,
+                                                        snd_mixer_selem_channel_id_t channel);
+gdouble               gam_element_model_get_normalized (GamElementModel  *model,
+                                                        enum ctl_dir      dir,
+                                                        snd_mixer_selem_channel_id_t channel);
+void                  gam_element_model_get_normalized_n (GamElementModel *model,
+                                                        enum ctl_dir      dir,
+                                                        const snd_mixer_selem_channel_id_t *channels,
+                                                        gdouble          *volumes,
+                                                        guint             count);
+gboolean              gam_element_model_get_switch     (GamElementModel  *model,
+                                                        enum ctl_dir      dir,
+                                                        snd_mixer_selem_channel_id_t channel);
+void                  gam_element_model_request        (GamElementModel  *model,
+                                                        enum ctl_dir      dir,
+                                                        const snd_mixer_selem_channel_id_t *channels,
+                                                        const gdouble    *volumes,
+                                                        guint             count,
+                                                        gint              round);
+
+G_END_DECLS
+
+#endif /* __GAM_ELEMENT_MODEL_H__ */
@@ -0,0 +1,206 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gam-element-registry.h"
+
+struct _GamElementRegistry
+{
+    /* lookups may come from any thread, and may add an entry */
+    GMutex      lock;
+
+    /*
+     * Of GamElementInfo, each allocated on its own so that it never moves;
+     * in the order of the element list, then in the order elements were
+     * added after the mixer was loaded.
+     */
+    GPtrArray  *infos;
+
+    /* element -> GamElementInfo */
+    GHashTable *index;
+
+    gchar      *delimiters;
+};
+
+static void
+gam_element_info_fill (GamElementInfo *info, snd_mixer_elem_t *elem, const gchar *delimiters)
+{
+    snd_mixer_selem_channel_id_t channel;
+    gchar *config_name;
+
+    info->elem = elem;
+    info->name = g_quark_from_string (snd_mixer_selem_get_name (elem));
+    info->index = snd_mixer_selem_get_index (elem);
+
+    config_name = g_strdelimit (g_strdup (snd_mixer_selem_get_name (elem)), delimiters, '_');
+    info->config_name = g_quark_from_string (config_name);
+    g_free (config_name);
+
+    info->active = snd_mixer_selem_is_active (elem) != 0;
+    info->enumerated = snd_mixer_selem_is_enumerated (elem) != 0;
+
+    info->has_volume[PLAYBACK] = snd_mixer_selem_has_playback_volume (elem) != 0;
+    info->has_volume[CAPTURE] = snd_mixer_selem_has_capture_volume (elem) != 0;
+    info->has_switch[PLAYBACK] = snd_mixer_selem_has_playback_switch (elem) != 0;
+    info->has_switch[CAPTURE] = snd_mixer_selem_has_capture_switch (elem) != 0;
+    info->is_mono[PLAYBACK] = snd_mixer_selem_is_playback_mono (elem) != 0;
+    info->is_mono[CAPTURE] = snd_mixer_selem_is_capture_mono (elem) != 0;
+
+    info->channels[PLAYBACK] = 0;
+    info->channels[CAPTURE] = 0;
+    for (channel = 0; channel <= SND_MIXER_SCHN_LAST; channel++) {
+        if (snd_mixer_selem_has_playback_channel (elem, channel))
+            info->channels[PLAYBACK] |= 1u << channel;
+        if (snd_mixer_selem_has_capture_channel (elem, channel))
+            info->channels[CAPTURE] |= 1u << channel;
+    }
+}
+
+/* with the registry locked */
+static GamElementInfo *
+gam_element_registry_append (GamElementRegistry *registry, snd_mixer_elem_t *elem)
+{
+    GamElementInfo *info;
+
+    info = g_new (GamElementInfo, 1);
+    gam_element_info_fill (info, elem, registry->delimiters);
+    g_ptr_array_add (registry->infos, info);
+    g_hash_table_insert (registry->index, elem, info);
+
+    return info;
+}
+
+/* the names become config names by replacing 'delimiters' with '_' */
+GamElementRegistry *
+gam_element_registry_new (snd_mixer_t *handle, const gchar *delimiters)
+{
+    GamElementRegistry *registry;
+    snd_mixer_elem_t *elem;
+
+    registry = g_new (GamElementRegistry, 1);
+    g_mutex_init (&registry->lock);
+    registry->infos = g_ptr_array_new_full (snd_mixer_get_count (handle), g_free);
+    registry->index = g_hash_table_new (NULL, NULL);
+    registry->delimiters = g_strdup (delimiters);
+
+    for (elem = snd_mixer_first_elem (handle); elem; elem = snd_mixer_elem_next (elem))
+        gam_element_registry_append (registry, elem);
+
+    return registry;
+}
+
+void
+gam_element_registry_free (GamElementRegistry *registry)
+{
+    if (registry == NULL)
+        return;
+
+    g_ptr_array_free (registry->infos, TRUE);
+    g_hash_table_destroy (registry->index);
+    g_free (registry->delimiters);
+    g_mutex_clear (&registry->lock);
+    g_free (registry);
+}
+
+guint
+gam_element_registry_get_count (GamElementRegistry *registry)
+{
+    guint count;
+
+    g_return_val_if_fail (registry != NULL, 0);
+
+    g_mutex_lock (&registry->lock);
+    count = registry->infos->len;
+    g_mutex_unlock (&registry->lock);
+
+    return count;
+}
+
+/* removed elements keep their place, with a NULL element */
+const GamElementInfo *
+gam_element_registry_get_nth (GamElementRegistry *registry, guint n)
+{
+    const GamElementInfo *info = NULL;
+
+    g_return_val_if_fail (registry != NULL, NULL);
+
+    g_mutex_lock (&registry->lock);
+    if (n < registry->infos->len)
+        info = g_ptr_array_index (registry->infos, n);
+    g_mutex_unlock (&registry->lock);
+
+    g_return_val_if_fail (info != NULL, NULL);
+
+    return info;
+}
+
+/* the entries stay where they are for the life of the registry */
+const GamElementInfo *
+gam_element_registry_lookup (GamElementRegistry *registry, snd_mixer_elem_t *elem)
+{
+    const GamElementInfo *info;
+
+    g_return_val_if_fail (registry != NULL, NULL);
+
+    g_mutex_lock (&registry->lock);
+    info = g_hash_table_lookup (registry->index, elem);
+    g_mutex_unlock (&registry->lock);
+
+    return info;
+}
+
+/* for an element ALSA added after the mixer was loaded; runs wherever the handle is polled */
+const GamElementInfo *
+gam_element_registry_add (GamElementRegistry *registry, snd_mixer_elem_t *elem)
+{
+    const GamElementInfo *info;
+
+    g_return_val_if_fail (registry != NULL, NULL);
+    g_return_val_if_fail (elem != NULL, NULL);
+
+    g_mutex_lock (&registry->lock);
+    info = g_hash_table_lookup (registry->index, elem);
+    if (info == NULL)
+        info = gam_element_registry_append (registry, elem);
+    g_mutex_unlock (&registry->lock);
+
+    return info;
+}
+
+/* the element is about to be freed, and its address may be reused */
+void
+gam_element_registry_remove (GamElementRegistry *registry, snd_mixer_elem_t *elem)
+{
+    GamElementInfo *info;
+
+    g_return_if_fail (registry != NULL);
+
+    g_mutex_lock (&registry->lock);
+    info = g_hash_table_lookup (registry->index, elem);
+    if (info != NULL) {
+        info->elem = NULL;
+        g_hash_table_remove (registry->index, elem);
+    }
+    g_mutex_unlock (&registry->lock);
+}
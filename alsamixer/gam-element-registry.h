@@ -0,0 +1,73 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_ELEMENT_REGISTRY_H__
+#define __GAM_ELEMENT_REGISTRY_H__
+
+#include <glib.h>
+#include <alsa/asoundlib.h>
+#include <alsamixer/volume_mapping.h>
+
+G_BEGIN_DECLS
+
+/*
+ * What a mixer knows about each of its simple elements, gathered in one
+ * pass over the element list when the mixer opens.  ALSA fixes the
+ * capabilities of a simple element when it creates it, so an entry only
+ * changes when its element is removed, and elements ALSA adds later are
+ * appended.  The arrays are indexed by enum ctl_dir.
+ */
+typedef struct _GamElementRegistry GamElementRegistry;
+
+typedef struct
+{
+    snd_mixer_elem_t *elem;          /* NULL once removed */
+    GQuark            name;
+    guint             index;
+    GQuark            config_name;
+    gboolean          active;
+    gboolean          enumerated;
+    gboolean          has_volume[2];
+    gboolean          has_switch[2];
+    gboolean          is_mono[2];
+    guint             channels[2];   /* a bit per channel */
+} GamElementInfo;
+
+/* elements with channels past the two front ones */
+#define GAM_ELEMENT_INFO_IS_SURROUND(info, dir) \
+    (((info)->channels[dir] >> SND_MIXER_SCHN_REAR_LEFT) != 0)
+
+GamElementRegistry   *gam_element_registry_new    (snd_mixer_t        *handle,
+                                                   const gchar        *delimiters);
+void                  gam_element_registry_free   (GamElementRegistry *registry);
+guint                 gam_element_registry_get_count (GamElementRegistry *registry);
+const GamElementInfo *gam_element_registry_get_nth (GamElementRegistry *registry,
+                                                   guint               n);
+const GamElementInfo *gam_element_registry_lookup (GamElementRegistry *registry,
+                                                   snd_mixer_elem_t   *elem);
+const GamElementInfo *gam_element_registry_add    (GamElementRegistry *registry,
+                                                   snd_mixer_elem_t   *elem);
+void                  gam_element_registry_remove (GamElementRegistry *registry,
+                                                   snd_mixer_elem_t   *elem);
+
+G_END_DECLS
+
+#endif /* __GAM_ELEMENT_REGISTRY_H__ */
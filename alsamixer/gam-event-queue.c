@@ -0,0 +1,112 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gam-event-queue.h"
+
+/*
+ * 'head' is only written by the consumer and 'tail' only by the producer;
+ * both count up forever and are reduced to a slot with 'mask'.  The atomic
+ * accesses order the slot contents against the index updates.
+ */
+struct _GamEventQueue
+{
+    GamEvent *events;
+    guint     mask;
+
+    gint      head;
+    gint      tail;
+    gint      overflow;
+};
+
+GamEventQueue *
+gam_event_queue_new (guint size)
+{
+    GamEventQueue *queue;
+    guint capacity = 1;
+
+    while (capacity < size)
+        capacity <<= 1;
+
+    queue = g_new0 (GamEventQueue, 1);
+    queue->events = g_new0 (GamEvent, capacity);
+    queue->mask = capacity - 1;
+
+    return queue;
+}
+
+void
+gam_event_queue_free (GamEventQueue *queue)
+{
+    if (queue == NULL)
+        return;
+
+    g_free (queue->events);
+    g_free (queue);
+}
+
+/* producer side */
+gboolean
+gam_event_queue_push (GamEventQueue *queue, gpointer elem, guint mask)
+{
+    const guint tail = (guint) queue->tail;
+    const guint head = (guint) g_atomic_int_get (&queue->head);
+    GamEvent *event;
+
+    if (tail - head > queue->mask) {
+        g_atomic_int_set (&queue->overflow, TRUE);
+        return FALSE;
+    }
+
+    event = &queue->events[tail & queue->mask];
+    event->elem = elem;
+    event->mask = mask;
+
+    g_atomic_int_set (&queue->tail, (gint) (tail + 1));
+
+    return TRUE;
+}
+
+/* consumer side */
+gboolean
+gam_event_queue_pop (GamEventQueue *queue, GamEvent *event)
+{
+    const guint head = (guint) queue->head;
+    const guint tail = (guint) g_atomic_int_get (&queue->tail);
+
+    if (head == tail)
+        return FALSE;
+
+    *event = queue->events[head & queue->mask];
+
+    g_atomic_int_set (&queue->head, (gint) (head + 1));
+
+    return TRUE;
+}
+
+gboolean
+gam_event_queue_take_overflow (GamEventQueue *queue)
+{
+    return g_atomic_int_compare_and_exchange (&queue->overflow, TRUE, FALSE);
+}
@@ -0,0 +1,54 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_EVENT_QUEUE_H__
+#define __GAM_EVENT_QUEUE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A bounded queue of element events from one producer thread to one
+ * consumer thread, without locks.  When the queue is full, push() fails and
+ * the queue remembers the overflow, so that the consumer can fall back to
+ * refreshing everything.
+ */
+typedef struct _GamEventQueue GamEventQueue;
+
+typedef struct
+{
+    gpointer elem;
+    guint    mask;
+} GamEvent;
+
+GamEventQueue *gam_event_queue_new           (guint          size);
+void           gam_event_queue_free          (GamEventQueue *queue);
+gboolean       gam_event_queue_push          (GamEventQueue *queue,
+                                              gpointer       elem,
+                                              guint          mask);
+gboolean       gam_event_queue_pop           (GamEventQueue *queue,
+                                              GamEvent      *event);
+gboolean       gam_event_queue_take_overflow (GamEventQueue *queue);
+
+G_END_DECLS
+
+#endif /* __GAM_EVENT_QUEUE_H__ */
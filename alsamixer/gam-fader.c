@@ -0,0 +1,350 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+/*
+ * Timed fades of the sliders.  All fades run from one source on the
+ * monotonic clock, which wakes on a grid of 'rate' ticks a second while a
+ * fade runs, at the exact end of a fade, and at the start of a scheduled
+ * one; it sleeps when nothing is due.  A fade writes its element at most
+ * once a tick, and only when that moves it to another hardware step.
+ *
+ * The writes are not noted as our own, so the mixer shows them like any
+ * outside change, once a frame.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "gam-fader.h"
+#include "gam-element-model.h"
+#include "gam-mixer-writer.h"
+
+typedef struct
+{
+    GamSlider                    *slider;
+    snd_mixer_selem_channel_id_t  channels[VOLUME_MAPPING_MAX_CHANNELS];
+    guint                         n_channels;
+    gdouble                       from[VOLUME_MAPPING_MAX_CHANNELS];
+    /* the hardware steps last posted */
+    gdouble                       written[VOLUME_MAPPING_MAX_CHANNELS];
+    gdouble                       target;
+    gint                          dir;
+    enum volume_fade_curve        curve;
+    /* monotonic time, in microseconds */
+    gint64                        start;
+    gint64                        duration;
+    gboolean                      running;
+} GamFade;
+
+typedef struct
+{
+    GamMixer                     *mixer;
+    snd_mixer_elem_t             *elem;
+    GamElementModel              *model;
+    struct volume_mapping        *mapping;
+    GamSlider                    *slider;
+    snd_mixer_selem_channel_id_t  channels[VOLUME_MAPPING_MAX_CHANNELS];
+    gdouble                       volumes[VOLUME_MAPPING_MAX_CHANNELS];
+    guint                         count;
+    gint                          dir;
+} GamFaderWrite;
+
+static gboolean gam_fader_dispatch (GSource     *source,
+                                    GSourceFunc  callback,
+                                    gpointer     data);
+
+static GSourceFuncs gam_fader_funcs = {
+    NULL,
+    NULL,
+    gam_fader_dispatch,
+    NULL,
+};
+
+static guint       fader_rate = GAM_FADER_DEFAULT_RATE;
+static GSource    *fader_source = NULL;
+/* GamSlider -> GamFade */
+static GHashTable *fader_fades = NULL;
+
+static gboolean
+gam_fader_write_failed (gpointer data)
+{
+    GamSlider * const gam_slider = GAM_SLIDER (data);
+
+    gam_fader_stop (gam_slider);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* on the writer thread */
+static void
+gam_fader_write_run (gpointer data)
+{
+    GamFaderWrite * const write = data;
+    gint err;
+
+    if (!gam_mixer_lock_elem (write->mixer, write->elem))
+        return;
+
+    err = volume_mapping_set_normalized_n (write->mapping, write->channels, write->volumes,
+                                           write->count, write->dir);
+
+    gam_mixer_unlock (write->mixer);
+
+    if (err < 0) {
+        g_warning ("%s: %s", gam_slider_get_name (write->slider), snd_strerror (err));
+        g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, gam_fader_write_failed,
+                         g_object_ref (write->slider), g_object_unref);
+    }
+}
+
+/* the slider and the mixer go on the main thread, where they live */
+static gboolean
+gam_fader_write_release (gpointer data)
+{
+    GamFaderWrite * const write = data;
+
+    g_object_unref (write->slider);
+    g_object_unref (write->mixer);
+    g_free (write);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * The model keeps the mapping for as long as the write needs it; a slider
+ * that goes away does not wait for the write, which holds it meanwhile.
+ */
+static void
+gam_fader_write_free (gpointer data)
+{
+    GamFaderWrite * const write = data;
+
+    g_object_unref (write->model);
+    g_idle_add (gam_fader_write_release, write);
+}
+
+/*
+ * The fade starts from wherever the channels are when it is due, not when
+ * it was set up, as the model has them.
+ */
+static void
+gam_fader_begin (GamFade *fade)
+{
+    GamElementModel * const model = gam_slider_get_model (fade->slider);
+    const enum ctl_dir type = gam_slider_get_direction (fade->slider);
+    gdouble highest = 0;
+    guint i;
+
+    fade->n_channels = gam_element_model_get_channels (model, type, fade->channels);
+    gam_element_model_get_normalized_n (model, type, fade->channels, fade->from, fade->n_channels);
+
+    for (i = 0; i < fade->n_channels; i++) {
+        fade->written[i] = fade->from[i];
+        highest = MAX (highest, fade->from[i]);
+    }
+
+    fade->dir = fade->target < highest ? -1 : 1;
+    fade->running = TRUE;
+}
+
+/* moves the fade to 'now'; returns TRUE once it has arrived */
+static gboolean
+gam_fader_step (GamFade *fade, gint64 now)
+{
+    GamMixer * const gam_mixer = gam_slider_get_mixer (fade->slider);
+    snd_mixer_elem_t * const elem = gam_slider_get_elem (fade->slider);
+    GamElementModel * const model = gam_slider_get_model (fade->slider);
+    const enum ctl_dir type = gam_slider_get_direction (fade->slider);
+    struct volume_mapping * const mapping = gam_element_model_get_mapping (model, type);
+    GamFaderWrite *write;
+    gboolean changed = FALSE;
+    gdouble t;
+    guint i;
+
+    /* a removed element ends its fade */
+    if (gam_mixer_get_elem_info (gam_mixer, elem) == NULL)
+        return TRUE;
+
+    if (!fade->running)
+        gam_fader_begin (fade);
+
+    t = fade->duration > 0 ? (gdouble) (now - fade->start) / fade->duration : 1;
+
+    write = g_new (GamFaderWrite, 1);
+
+    for (i = 0; i < fade->n_channels; i++) {
+        gdouble step;
+
+        write->volumes[i] = volume_fade_position (fade->curve, fade->from[i], fade->target, t);
+
+        step = gam_element_model_quantize (model, type, write->volumes[i], fade->dir);
+        if (step != fade->written[i]) {
+            fade->written[i] = step;
+            changed = TRUE;
+        }
+    }
+
+    if (changed) {
+        write->mixer = g_object_ref (gam_mixer);
+        write->elem = elem;
+        write->model = g_object_ref (model);
+        write->mapping = mapping;
+        write->slider = g_object_ref (fade->slider);
+        memcpy (write->channels, fade->channels, fade->n_channels * sizeof (*fade->channels));
+        write->count = fade->n_channels;
+        write->dir = fade->dir;
+
+        /* the mapping is the slot, the slider's own writes use its widgets */
+        gam_mixer_writer_post (mapping, fade->slider, gam_fader_write_run, write, gam_fader_write_free);
+    } else
+        g_free (write);
+
+    return t >= 1;
+}
+
+static gint64
+gam_fader_next_wake (gint64 wake, gint64 time)
+{
+    return wake < 0 || time < wake ? time : wake;
+}
+
+static void
+gam_fader_tick (void)
+{
+    const gint64 now = g_get_monotonic_time ();
+    const gint64 interval = G_USEC_PER_SEC / fader_rate;
+    GHashTableIter iter;
+    gpointer fade_data;
+    gint64 wake = -1;
+
+    g_hash_table_iter_init (&iter, fader_fades);
+    while (g_hash_table_iter_next (&iter, NULL, &fade_data)) {
+        GamFade * const fade = fade_data;
+
+        if (now < fade->start) {
+            wake = gam_fader_next_wake (wake, fade->start);
+            continue;
+        }
+
+        if (gam_fader_step (fade, now)) {
+            g_hash_table_iter_remove (&iter);
+            continue;
+        }
+
+        /* ticks are shared by all fades, and the last one lands on the end */
+        wake = gam_fader_next_wake (wake, (now / interval + 1) * interval);
+        wake = gam_fader_next_wake (wake, fade->start + fade->duration);
+    }
+
+    g_source_set_ready_time (fader_source, wake);
+}
+
+static gboolean
+gam_fader_dispatch (GSource *source, GSourceFunc callback, gpointer data)
+{
+    gam_fader_tick ();
+
+    return G_SOURCE_CONTINUE;
+}
+
+/* sets how many times a second the running fades are written */
+void
+gam_fader_set_rate (guint rate)
+{
+    fader_rate = CLAMP (rate, 1, 1000);
+}
+
+guint
+gam_fader_get_rate (void)
+{
+    return fader_rate;
+}
+
+void
+gam_fader_start (GamSlider              *gam_slider,
+                 gdouble                 target,
+                 guint                   duration,
+                 enum volume_fade_curve  curve)
+{
+    gam_fader_start_at (gam_slider, target, duration, curve, NULL);
+}
+
+/*
+ * Fades all channels of the slider to 'target', a normalized volume, over
+ * 'duration' milliseconds, starting at 'start_time' or at once when that
+ * is NULL.  A fade the slider already has is replaced.  The wall clock is
+ * only read here, so the fade is not moved when the clock is set later.
+ */
+void
+gam_fader_start_at (GamSlider              *gam_slider,
+                    gdouble                 target,
+                    guint                   duration,
+                    enum volume_fade_curve  curve,
+                    GDateTime              *start_time)
+{
+    GamFade *fade;
+    gint64 delay = 0;
+
+    g_return_if_fail (GAM_IS_SLIDER (gam_slider));
+
+    if (fader_source == NULL) {
+        fader_fades = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+        fader_source = g_source_new (&gam_fader_funcs, sizeof (GSource));
+        g_source_set_name (fader_source, "gam-fader");
+        g_source_attach (fader_source, NULL);
+    }
+
+    if (start_time != NULL)
+        delay = g_date_time_to_unix (start_time) * G_USEC_PER_SEC +
+                g_date_time_get_microsecond (start_time) - g_get_real_time ();
+
+    fade = g_new0 (GamFade, 1);
+    fade->slider = gam_slider;
+    fade->target = CLAMP (target, 0, 1);
+    fade->curve = curve;
+    fade->start = g_get_monotonic_time () + MAX (delay, 0);
+    fade->duration = (gint64) duration * 1000;
+    fade->running = FALSE;
+
+    g_hash_table_insert (fader_fades, gam_slider, fade);
+
+    g_source_set_ready_time (fader_source, 0);
+}
+
+/* the channels stay where the fade had taken them */
+void
+gam_fader_stop (GamSlider *gam_slider)
+{
+    if (fader_fades == NULL)
+        return;
+
+    g_hash_table_remove (fader_fades, gam_slider);
+}
+
+gboolean
+gam_fader_is_fading (GamSlider *gam_slider)
+{
+    return fader_fades != NULL && g_hash_table_contains (fader_fades, gam_slider);
+}
@@ -0,0 +1,48 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_FADER_H__
+#define __GAM_FADER_H__
+
+#include <alsamixer/gam-slider.h>
+
+G_BEGIN_DECLS
+
+/* ticks a second when no rate is set */
+#define GAM_FADER_DEFAULT_RATE 30
+
+void     gam_fader_set_rate  (guint                   rate);
+guint    gam_fader_get_rate  (void);
+void     gam_fader_start     (GamSlider              *gam_slider,
+                              gdouble                 target,
+                              guint                   duration,
+                              enum volume_fade_curve  curve);
+void     gam_fader_start_at  (GamSlider              *gam_slider,
+                              gdouble                 target,
+                              guint                   duration,
+                              enum volume_fade_curve  curve,
+                              GDateTime              *start_time);
+void     gam_fader_stop      (GamSlider              *gam_slider);
+gboolean gam_fader_is_fading (GamSlider              *gam_slider);
+
+G_END_DECLS
+
+#endif /* __GAM_FADER_H__ */
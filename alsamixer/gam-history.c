@@ -0,0 +1,160 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gam-history.h"
+
+/*
+ * 'first' is the slot of the oldest entry, 'count' the number of entries
+ * and 'done' how many of them are not undone; the ones after 'done' can be
+ * redone until something new is pushed.
+ */
+struct _GamHistory
+{
+    GamHistoryEntry **entries;
+    guint             size;
+    guint             first;
+    guint             count;
+    guint             done;
+};
+
+/*
+ * An entry for every channel in 'channels', a bit per channel the element
+ * has in that direction; the element itself is only read by the writer.
+ */
+GamHistoryEntry *
+gam_history_entry_new (snd_mixer_elem_t *elem, gboolean playback, guint channels)
+{
+    GamHistoryEntry *entry;
+    snd_mixer_selem_channel_id_t channel;
+    guint count = 0;
+
+    for (channel = 0; channel <= SND_MIXER_SCHN_LAST; channel++) {
+        if (channels & (1u << channel))
+            count++;
+    }
+
+    entry = g_malloc0 (sizeof (GamHistoryEntry) + count * sizeof (GamHistoryValue));
+    entry->elem = elem;
+    entry->playback = playback;
+
+    for (channel = 0; channel <= SND_MIXER_SCHN_LAST && entry->count < count; channel++) {
+        if (channels & (1u << channel))
+            entry->values[entry->count++].channel = channel;
+    }
+
+    return entry;
+}
+
+/* a gesture that ends where it began is not worth keeping */
+gboolean
+gam_history_entry_is_change (const GamHistoryEntry *entry)
+{
+    guint i;
+
+    for (i = 0; i < entry->count; i++) {
+        if (entry->values[i].old_value != entry->values[i].new_value)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+GamHistory *
+gam_history_new (guint size)
+{
+    GamHistory *history;
+
+    history = g_new0 (GamHistory, 1);
+    history->entries = g_new0 (GamHistoryEntry *, MAX (size, 1));
+    history->size = MAX (size, 1);
+
+    return history;
+}
+
+void
+gam_history_free (GamHistory *history)
+{
+    guint i;
+
+    if (history == NULL)
+        return;
+
+    for (i = 0; i < history->count; i++)
+        g_free (history->entries[(history->first + i) % history->size]);
+
+    g_free (history->entries);
+    g_free (history);
+}
+
+/* takes 'entry'; what could be redone is gone */
+void
+gam_history_push (GamHistory *history, GamHistoryEntry *entry)
+{
+    g_return_if_fail (history != NULL);
+
+    while (history->count > history->done) {
+        history->count--;
+        g_free (history->entries[(history->first + history->count) % history->size]);
+    }
+
+    if (history->count == history->size) {
+        g_free (history->entries[history->first]);
+        history->first = (history->first + 1) % history->size;
+        history->count--;
+        history->done--;
+    }
+
+    history->entries[(history->first + history->count) % history->size] = entry;
+    history->count++;
+    history->done++;
+}
+
+/* the entry whose old values are to be written back, or NULL */
+const GamHistoryEntry *
+gam_history_undo (GamHistory *history)
+{
+    g_return_val_if_fail (history != NULL, NULL);
+
+    if (history->done == 0)
+        return NULL;
+
+    history->done--;
+
+    return history->entries[(history->first + history->done) % history->size];
+}
+
+/* the entry whose new values are to be written again, or NULL */
+const GamHistoryEntry *
+gam_history_redo (GamHistory *history)
+{
+    g_return_val_if_fail (history != NULL, NULL);
+
+    if (history->done == history->count)
+        return NULL;
+
+    history->done++;
+
+    return history->entries[(history->first + history->done - 1) % history->size];
+}
@@ -0,0 +1,66 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_HISTORY_H__
+#define __GAM_HISTORY_H__
+
+#include <glib.h>
+#include <alsa/asoundlib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A bounded undo history: a ring of the last 'size' changes, the oldest is
+ * dropped to make room.  Each entry holds the raw values of the channels
+ * of one element before and after a whole gesture.
+ */
+typedef struct _GamHistory GamHistory;
+
+typedef struct
+{
+    snd_mixer_selem_channel_id_t channel;
+    glong                        old_value;
+    glong                        new_value;
+} GamHistoryValue;
+
+typedef struct
+{
+    snd_mixer_elem_t *elem;
+    gboolean          playback;
+    guint             count;
+    GamHistoryValue   values[];
+} GamHistoryEntry;
+
+GamHistoryEntry *gam_history_entry_new (snd_mixer_elem_t *elem,
+                                        gboolean          playback,
+                                        guint             channels);
+gboolean         gam_history_entry_is_change (const GamHistoryEntry *entry);
+
+GamHistory      *gam_history_new       (guint             size);
+void             gam_history_free      (GamHistory       *history);
+void             gam_history_push      (GamHistory       *history,
+                                        GamHistoryEntry  *entry);
+const GamHistoryEntry *gam_history_undo (GamHistory      *history);
+const GamHistoryEntry *gam_history_redo (GamHistory      *history);
+
+G_END_DECLS
+
+#endif /* __GAM_HISTORY_H__ */
@@ -0,0 +1,343 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+/*
+ * Link groups tie the playback volumes of elements together, across cards:
+ * moving the slider of one member sets the others to the same gain, each
+ * shifted by its own offset in dB.  A group is a small table of members;
+ * the sliders know nothing of it.
+ *
+ * Only a hand on a slider fans out.  The members are written without
+ * noting the writes as our own, so their sliders show the new gains, but a
+ * slider that shows a change never writes it back, so the events of the
+ * members cannot start another round.
+ *
+ * The mixers of the members are pinned, so that a long unload time does not
+ * take them away; a member whose mixer is still being built gets the last
+ * gain of its group once it is.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+
+#include "gam-link.h"
+#include "gam-element-model.h"
+#include "gam-mixer-writer.h"
+
+typedef struct
+{
+    gchar            *card;
+    gchar            *elem_name;
+    glong             offset;     /* 1/100 dB */
+
+    /* looked up when needed, forgotten when the card's tab closes */
+    GamMixer         *mixer;
+    snd_mixer_elem_t *elem;
+
+    /* its mixer was still being built at the last fan-out */
+    gboolean          pending;
+} GamLinkMember;
+
+typedef struct
+{
+    GamApp *app;
+    GArray *members;              /* of GamLinkMember */
+
+    /* the last fan-out, for the members whose mixers come later */
+    gint    leader;               /* index in members, or -1 */
+    glong   dB;
+    gint    dir;
+} GamLinkGroup;
+
+typedef struct
+{
+    GamMixer         *mixer;
+    snd_mixer_elem_t *elem;
+    glong             dB;
+} GamLinkTarget;
+
+typedef struct
+{
+    gint          dir;
+    guint         count;
+    GamLinkTarget targets[];
+} GamLinkWrite;
+
+static GPtrArray *link_groups = NULL;
+
+static void gam_link_mixer_loaded_cb (GamApp       *gam_app,
+                                      const gchar  *card,
+                                      GamLinkGroup *group);
+
+static void
+gam_link_mixer_gone (gpointer data, GObject *mixer)
+{
+    GamLinkGroup * const group = data;
+    guint i;
+
+    for (i = 0; i < group->members->len; i++) {
+        GamLinkMember * const member = &g_array_index (group->members, GamLinkMember, i);
+
+        if (member->mixer == GAM_MIXER (mixer)) {
+            member->mixer = NULL;
+            member->elem = NULL;
+        }
+    }
+}
+
+static gboolean
+gam_link_resolve (GamLinkGroup *group, GamLinkMember *member)
+{
+    GtkWidget *mixer;
+
+    if (member->mixer != NULL)
+        return member->elem != NULL;
+
+    mixer = gam_app_get_mixer (group->app, member->card);
+    if (mixer == NULL)
+        return FALSE;
+
+    member->mixer = GAM_MIXER (mixer);
+    member->elem = gam_mixer_find_elem (member->mixer, member->elem_name);
+    g_object_weak_ref (G_OBJECT (mixer), gam_link_mixer_gone, group);
+
+    return member->elem != NULL;
+}
+
+/* the gain of 'member' when the leader of its group is at 'dB' */
+static glong
+gam_link_member_dB (const GamLinkMember *leader, const GamLinkMember *member, glong dB)
+{
+    /* a muted leader mutes the members too */
+    return dB <= SND_CTL_TLV_DB_GAIN_MUTE ? dB : dB - leader->offset + member->offset;
+}
+
+/*
+ * Adds a group from 'spec', which lists its members as CARD,ELEMENT or
+ * CARD,ELEMENT,OFFSET separated by ';', e.g. "hw:0,Master;hw:2,PCM,-6".
+ * OFFSET is in dB and defaults to 0.
+ */
+gboolean
+gam_link_add_group (GamApp *gam_app, const gchar *spec)
+{
+    GamLinkGroup *group;
+    gchar **members;
+    guint i;
+
+    g_return_val_if_fail (GAM_IS_APP (gam_app), FALSE);
+
+    group = g_new (GamLinkGroup, 1);
+    group->app = gam_app;
+    group->members = g_array_new (FALSE, TRUE, sizeof (GamLinkMember));
+    group->leader = -1;
+
+    members = g_strsplit (spec, ";", -1);
+
+    for (i = 0; members[i] != NULL; i++) {
+        gchar **fields = g_strsplit (members[i], ",", 3);
+        GamLinkMember member = { NULL, };
+
+        if (fields[0] == NULL || fields[1] == NULL) {
+            g_strfreev (fields);
+            continue;
+        }
+
+        member.card = g_strdup (g_strstrip (fields[0]));
+        member.elem_name = g_strdup (g_strstrip (fields[1]));
+        if (fields[2] != NULL)
+            member.offset = (glong) (g_ascii_strtod (fields[2], NULL) * 100);
+
+        g_array_append_val (group->members, member);
+        g_strfreev (fields);
+    }
+
+    g_strfreev (members);
+
+    if (group->members->len < 2) {
+        for (i = 0; i < group->members->len; i++) {
+            g_free (g_array_index (group->members, GamLinkMember, i).card);
+            g_free (g_array_index (group->members, GamLinkMember, i).elem_name);
+        }
+        g_array_free (group->members, TRUE);
+        g_free (group);
+
+        return FALSE;
+    }
+
+    if (link_groups == NULL)
+        link_groups = g_ptr_array_new ();
+    g_ptr_array_add (link_groups, group);
+
+    for (i = 0; i < group->members->len; i++)
+        gam_app_pin_mixer (gam_app, g_array_index (group->members, GamLinkMember, i).card);
+    g_signal_connect (G_OBJECT (gam_app), "mixer_loaded",
+                      G_CALLBACK (gam_link_mixer_loaded_cb), group);
+
+    return TRUE;
+}
+
+static gboolean
+gam_link_unref_mixers (gpointer data)
+{
+    GamLinkWrite * const write = data;
+    guint i;
+
+    for (i = 0; i < write->count; i++)
+        g_object_unref (write->targets[i].mixer);
+    g_free (write);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* the mixers must go on the main thread, where their widgets live */
+static void
+gam_link_write_free (gpointer data)
+{
+    g_idle_add (gam_link_unref_mixers, data);
+}
+
+/* on the writer thread */
+static void
+gam_link_write_run (gpointer data)
+{
+    GamLinkWrite * const write = data;
+    guint i;
+
+    for (i = 0; i < write->count; i++) {
+        GamLinkTarget * const target = &write->targets[i];
+        gint err;
+
+        if (!gam_mixer_lock_elem (target->mixer, target->elem))
+            continue;
+
+        err = snd_mixer_selem_set_playback_dB_all (target->elem, target->dB, write->dir);
+        if (err < 0)
+            g_warning ("%s: %s", snd_mixer_selem_get_name (target->elem), snd_strerror (err));
+
+        gam_mixer_unlock (target->mixer);
+    }
+}
+
+/*
+ * Called with the volumes a slider has just posted; if its element is in a
+ * group, the other members get one batch of writes.  A batch that still
+ * waits for the writer is replaced.
+ */
+void
+gam_link_fan_out (GamSlider *gam_slider, const gdouble *volumes, guint count, gint dir)
+{
+    GamMixer * const gam_mixer = gam_slider_get_mixer (gam_slider);
+    snd_mixer_elem_t * const elem = gam_slider_get_elem (gam_slider);
+    GamLinkGroup *group = NULL;
+    GamLinkMember *leader = NULL;
+    GamLinkWrite *write;
+    gdouble level = 0;
+    glong dB;
+    guint i, j;
+
+    if (link_groups == NULL)
+        return;
+
+    for (i = 0; i < link_groups->len && leader == NULL; i++) {
+        group = g_ptr_array_index (link_groups, i);
+
+        for (j = 0; j < group->members->len; j++) {
+            GamLinkMember * const member = &g_array_index (group->members, GamLinkMember, j);
+
+            if (gam_link_resolve (group, member) && member->mixer == gam_mixer && member->elem == elem) {
+                leader = member;
+                break;
+            }
+        }
+    }
+
+    if (leader == NULL)
+        return;
+
+    /* the members follow the loudest channel */
+    for (i = 0; i < count; i++)
+        level = MAX (level, volumes[i]);
+
+    if (gam_element_model_to_dB (gam_slider_get_model (gam_slider), PLAYBACK, level, dir, &dB) < 0)
+        return;
+
+    write = g_malloc (sizeof (GamLinkWrite) + group->members->len * sizeof (GamLinkTarget));
+    write->dir = dir;
+    write->count = 0;
+
+    for (j = 0; j < group->members->len; j++) {
+        GamLinkMember * const member = &g_array_index (group->members, GamLinkMember, j);
+        GamLinkTarget * const target = &write->targets[write->count];
+
+        if (member == leader)
+            continue;
+
+        member->pending = FALSE;
+        if (!gam_link_resolve (group, member)) {
+            member->pending = gam_app_get_mixer_loading (group->app, member->card);
+            continue;
+        }
+
+        target->mixer = g_object_ref (member->mixer);
+        target->elem = member->elem;
+        target->dB = gam_link_member_dB (leader, member, dB);
+        write->count++;
+    }
+
+    group->leader = leader - &g_array_index (group->members, GamLinkMember, 0);
+    group->dB = dB;
+    group->dir = dir;
+
+    gam_mixer_writer_post (group, group, gam_link_write_run, write, gam_link_write_free);
+}
+
+/* the members on 'card' that missed the last fan-out catch up with it */
+static void
+gam_link_mixer_loaded_cb (GamApp *gam_app, const gchar *card, GamLinkGroup *group)
+{
+    guint j;
+
+    for (j = 0; j < group->members->len; j++) {
+        GamLinkMember * const member = &g_array_index (group->members, GamLinkMember, j);
+        GamLinkWrite *write;
+
+        if (!member->pending || g_strcmp0 (member->card, card) != 0)
+            continue;
+
+        member->pending = FALSE;
+        if (group->leader < 0 || !gam_link_resolve (group, member))
+            continue;
+
+        write = g_malloc (sizeof (GamLinkWrite) + sizeof (GamLinkTarget));
+        write->dir = group->dir;
+        write->count = 1;
+        write->targets[0].mixer = g_object_ref (member->mixer);
+        write->targets[0].elem = member->elem;
+        write->targets[0].dB = gam_link_member_dB (&g_array_index (group->members, GamLinkMember, group->leader),
+                                                   member, group->dB);
+
+        /* a slot of its own, a newer batch of the group must not replace it */
+        gam_mixer_writer_post (member, group, gam_link_write_run, write, gam_link_write_free);
+    }
+}
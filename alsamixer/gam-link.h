@@ -0,0 +1,39 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_LINK_H__
+#define __GAM_LINK_H__
+
+#include <alsamixer/gam-app.h>
+#include <alsamixer/gam-slider.h>
+
+G_BEGIN_DECLS
+
+gboolean gam_link_add_group (GamApp              *gam_app,
+                             const gchar         *spec);
+void     gam_link_fan_out   (GamSlider           *gam_slider,
+                             const gdouble       *volumes,
+                             guint                count,
+                             gint                 dir);
+
+G_END_DECLS
+
+#endif /* __GAM_LINK_H__ */
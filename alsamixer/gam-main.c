@@ -27,12 +27,70 @@
 #include <gtk/gtk.h>
 
 #include "gam-app.h"
+#include "gam-fader.h"
+#include "gam-link.h"
+#include "gam-media-keys.h"
+#include "gam-mixer-source.h"
+#include "gam-stats-dlg.h"
+#include "volume_mapping.h"
+
+static gchar    *opt_curve = NULL;
+static gboolean  opt_event_thread = FALSE;
+static gboolean  opt_event_stats = FALSE;
+static gint      opt_fade_rate = GAM_FADER_DEFAULT_RATE;
+static gchar   **opt_links = NULL;
+static gint      opt_unload_time = 0;
+#ifdef HAVE_LIBX11
+static gchar    *opt_media_keys = NULL;
+#endif
+
+static GOptionEntry option_entries[] =
+{
+    { "curve", 'c', 0, G_OPTION_ARG_STRING, &opt_curve,
+      N_("Volume curve of the sliders: auto, cubic, linear or raw"), N_("CURVE") },
+    { "event-thread", 't', 0, G_OPTION_ARG_NONE, &opt_event_thread,
+      N_("Handle mixer events on a thread of their own"), NULL },
+    { "event-stats", 's', 0, G_OPTION_ARG_NONE, &opt_event_stats,
+      N_("Show how many events each mixer element sends"), NULL },
+    { "fade-rate", 'f', 0, G_OPTION_ARG_INT, &opt_fade_rate,
+      N_("Times a second a fade writes its element"), N_("RATE") },
+    { "link", 'l', 0, G_OPTION_ARG_STRING_ARRAY, &opt_links,
+      N_("Move elements together, offsets in dB, e.g. 'hw:0,Master;hw:2,PCM,-6'"), N_("GROUP") },
+    { "unload-time", 'u', 0, G_OPTION_ARG_INT, &opt_unload_time,
+      N_("Unload the mixer of a tab not shown for this many seconds"), N_("SECONDS") },
+#ifdef HAVE_LIBX11
+    { "media-keys", 'k', 0, G_OPTION_ARG_STRING, &opt_media_keys,
+      N_("Bind the volume keys of the keyboard to an element, e.g. hw:0,Master"), N_("CARD,ELEMENT") },
+#endif
+    { NULL }
+};
+
+static gboolean
+parse_curve (const gchar *name)
+{
+    if (name == NULL || g_strcmp0 (name, "auto") == 0)
+        gam_app_set_volume_curve (VOLUME_MAPPING_CURVE_AUTO);
+    else if (g_strcmp0 (name, "cubic") == 0)
+        gam_app_set_volume_curve (VOLUME_MAPPING_CURVE_CUBIC);
+    else if (g_strcmp0 (name, "linear") == 0)
+        gam_app_set_volume_curve (VOLUME_MAPPING_CURVE_LINEAR_DB);
+    else if (g_strcmp0 (name, "raw") == 0)
+        gam_app_set_volume_curve (VOLUME_MAPPING_CURVE_RAW);
+    else
+        return FALSE;
+
+    return TRUE;
+}
 
 int
 main (int argc, char *argv[])
 {
     GtkWidget *app;
-    GError    *error;
+    GError    *error = NULL;
+    guint      i;
+#ifdef HAVE_LIBX11
+    GamMediaKeys *media_keys = NULL;
+#endif
 
 #ifdef ENABLE_NLS
     bindtextdomain (GETTEXT_PACKAGE, PACKAGE_LOCALE_DIR);
@@ -41,8 +99,8 @@ main (int argc, char *argv[])
 #endif
     if (!gtk_init_with_args (&argc, &argv,
                 "alsamixer",
-                NULL,
-                NULL,
+                option_entries,
+                GETTEXT_PACKAGE,
                 &error))
     {
         g_printerr(_("%s\nRun '%s --help' to see a full list of available command line options.\n"),
@@ -50,13 +108,50 @@ main (int argc, char *argv[])
                    argv[0]);
         return 1;
     }
+
+    if (!parse_curve (opt_curve)) {
+        g_printerr (_("Unknown volume curve '%s'.\n"), opt_curve);
+        return 1;
+    }
+
+    gam_mixer_source_set_threaded (opt_event_thread);
+    gam_fader_set_rate (MAX (opt_fade_rate, 1));
  
     app = gam_app_new ();
 
     if (!app)
         return 1;
 
+    gam_app_set_unload_time (GAM_APP (app), MAX (opt_unload_time, 0));
+
+    if (opt_event_stats)
+        gtk_widget_show (gam_stats_dlg_new (GAM_APP (app)));
+
+    for (i = 0; opt_links != NULL && opt_links[i] != NULL; i++) {
+        if (!gam_link_add_group (GAM_APP (app), opt_links[i]))
+            g_printerr (_("A link group needs two members or more: '%s'.\n"), opt_links[i]);
+    }
+
+#ifdef HAVE_LIBX11
+    if (opt_media_keys) {
+        gchar **binding = g_strsplit (opt_media_keys, ",", 2);
+
+        if (binding[0] == NULL || binding[1] == NULL) {
+            g_printerr (_("The volume keys need a card and an element, like 'hw:0,Master'.\n"));
+            g_strfreev (binding);
+            return 1;
+        }
+
+        media_keys = gam_media_keys_new (GAM_APP (app), binding[0], binding[1]);
+        g_strfreev (binding);
+    }
+#endif
+
     gam_app_run (GAM_APP (app));
 
+#ifdef HAVE_LIBX11
+    gam_media_keys_free (media_keys);
+#endif
+
     return 0;
 }
@@ -0,0 +1,449 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+/*
+ * Global grabs of the volume keys of the keyboard, bound to one element of
+ * one card.  Key presses, auto-repeat included, only add up a pending step;
+ * one frame later the sum is written as a single change, so a held key
+ * costs one write a frame however fast it repeats.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_LIBX11
+
+#include <gdk/gdkx.h>
+#include <X11/Xlib.h>
+#include <X11/XKBlib.h>
+#include <X11/XF86keysym.h>
+
+#include "gam-media-keys.h"
+#include "gam-element-model.h"
+#include "gam-mixer.h"
+#include "gam-mixer-writer.h"
+#include "volume_mapping.h"
+
+/* volume change of one key press, in normalized slider units */
+#define GAM_MEDIA_KEYS_STEP 0.05
+
+/* the wait that gathers key repeats, a frame at 60 Hz */
+#define GAM_MEDIA_KEYS_DELAY 16
+
+enum
+{
+    KEY_RAISE,
+    KEY_LOWER,
+    KEY_MUTE,
+    N_KEYS
+};
+
+struct _GamMediaKeys
+{
+    GamApp                *app;
+    gchar                 *card;
+    gchar                 *elem_name;
+    KeyCode                keycodes[N_KEYS];
+
+    /* key presses not written yet */
+    gint                   pending_steps;
+    gboolean               pending_mute;
+    gboolean               mute_down;
+    guint                  apply_id;
+    gulong                 loaded_id;
+
+    /* the element the keys are bound to, while its card has a tab */
+    GamMixer              *mixer;
+    snd_mixer_elem_t      *elem;
+    const GamElementInfo  *info;
+    GamElementModel       *model;
+
+    /*
+     * What was posted last; while writes are still on their way the
+     * hardware does not show it yet, and the next step starts from here.
+     */
+    gint                   in_flight;
+    snd_mixer_selem_channel_id_t channels[VOLUME_MAPPING_MAX_CHANNELS];
+    gdouble                volumes[VOLUME_MAPPING_MAX_CHANNELS];
+    guint                  n_channels;
+    gint                   mute;
+};
+
+typedef struct
+{
+    GamMediaKeys                 *keys;
+    /* the model keeps the mapping for as long as the write needs it */
+    GamElementModel              *model;
+    struct volume_mapping        *mapping;
+    snd_mixer_selem_channel_id_t  channels[VOLUME_MAPPING_MAX_CHANNELS];
+    gdouble                       volumes[VOLUME_MAPPING_MAX_CHANNELS];
+    guint                         count;
+    gint                          dir;
+    /* the playback switch to set, or -1 for a volume write */
+    gint                          mute;
+} GamMediaKeysWrite;
+
+/* with and without Caps Lock and Num Lock */
+static const guint grab_modifiers[] = { 0, LockMask, Mod2Mask, LockMask | Mod2Mask };
+
+static const KeySym key_syms[N_KEYS] = {
+    [KEY_RAISE] = XF86XK_AudioRaiseVolume,
+    [KEY_LOWER] = XF86XK_AudioLowerVolume,
+    [KEY_MUTE]  = XF86XK_AudioMute,
+};
+
+/* on the writer thread */
+static void
+gam_media_keys_write_run (gpointer data)
+{
+    GamMediaKeysWrite * const write = data;
+    GamMediaKeys * const keys = write->keys;
+    gint err;
+
+    if (!gam_mixer_lock_elem (keys->mixer, keys->elem))
+        return;
+
+    if (write->mute >= 0)
+        err = snd_mixer_selem_set_playback_switch_all (keys->elem, write->mute);
+    else
+        err = volume_mapping_set_normalized_n (write->mapping, write->channels, write->volumes,
+                                               write->count, write->dir);
+
+    gam_mixer_unlock (keys->mixer);
+
+    if (err < 0)
+        g_warning ("%s: %s", keys->elem_name, snd_strerror (err));
+}
+
+static void
+gam_media_keys_write_free (gpointer data)
+{
+    GamMediaKeysWrite * const write = data;
+
+    g_atomic_int_add (&write->keys->in_flight, -1);
+    g_object_unref (write->model);
+    g_free (write);
+}
+
+static void
+gam_media_keys_post (GamMediaKeys *keys, gpointer slot, GamMediaKeysWrite *write)
+{
+    write->keys = keys;
+    write->model = g_object_ref (keys->model);
+    write->mapping = gam_element_model_get_mapping (keys->model, PLAYBACK);
+
+    g_atomic_int_inc (&keys->in_flight);
+    gam_mixer_writer_post (slot, keys, gam_media_keys_write_run, write, gam_media_keys_write_free);
+}
+
+/* forgets the element; its pending writes are dropped */
+static void
+gam_media_keys_forget (GamMediaKeys *keys)
+{
+    gam_mixer_writer_cancel (keys);
+
+    g_clear_object (&keys->model);
+
+    keys->mixer = NULL;
+    keys->elem = NULL;
+    keys->info = NULL;
+    keys->n_channels = 0;
+    keys->mute = -1;
+}
+
+/* the tab of the card is closing */
+static void
+gam_media_keys_mixer_gone (gpointer data, GObject *mixer)
+{
+    gam_media_keys_forget (data);
+}
+
+static void
+gam_media_keys_release (GamMediaKeys *keys)
+{
+    if (keys->mixer)
+        g_object_weak_unref (G_OBJECT (keys->mixer), gam_media_keys_mixer_gone, keys);
+
+    gam_media_keys_forget (keys);
+}
+
+/* finds the element again, the card may have come back since */
+static gboolean
+gam_media_keys_resolve (GamMediaKeys *keys)
+{
+    GtkWidget *mixer;
+    snd_mixer_elem_t *elem = NULL;
+    GamElementModel *model = NULL;
+
+    mixer = gam_app_get_mixer (keys->app, keys->card);
+
+    /* still there, nothing to look up again */
+    if (mixer != NULL && GAM_MIXER (mixer) == keys->mixer &&
+        gam_mixer_get_elem_info (keys->mixer, keys->elem) != NULL)
+        return TRUE;
+
+    if (mixer != NULL)
+        elem = gam_mixer_find_elem (GAM_MIXER (mixer), keys->elem_name);
+    if (elem != NULL)
+        model = gam_mixer_get_model (GAM_MIXER (mixer), elem);
+
+    if (elem != NULL && GAM_MIXER (mixer) == keys->mixer && elem == keys->elem)
+        return TRUE;
+
+    gam_media_keys_release (keys);
+
+    if (elem == NULL || model == NULL)
+        return FALSE;
+
+    keys->mixer = GAM_MIXER (mixer);
+    keys->elem = elem;
+    keys->info = gam_mixer_get_elem_info (keys->mixer, elem);
+    keys->model = g_object_ref (model);
+    g_object_weak_ref (G_OBJECT (keys->mixer), gam_media_keys_mixer_gone, keys);
+
+    return TRUE;
+}
+
+/* writes what the keys added up since the last time, from the volumes the model has */
+static void
+gam_media_keys_step_volume (GamMediaKeys *keys, gint steps)
+{
+    GamMediaKeysWrite *write;
+    const gint dir = steps < 0 ? -1 : 1;
+    guint i;
+
+    if (!keys->info->has_volume[PLAYBACK])
+        return;
+
+    /* the last posted volumes are still ahead of the hardware */
+    if (g_atomic_int_get (&keys->in_flight) == 0 || keys->n_channels == 0) {
+        keys->n_channels = gam_element_model_get_channels (keys->model, PLAYBACK, keys->channels);
+        gam_element_model_get_normalized_n (keys->model, PLAYBACK, keys->channels, keys->volumes,
+                                            keys->n_channels);
+    }
+
+    write = g_new (GamMediaKeysWrite, 1);
+
+    for (i = 0; i < keys->n_channels; i++) {
+        keys->volumes[i] = gam_element_model_quantize (keys->model, PLAYBACK,
+                                                       CLAMP (keys->volumes[i] + steps * GAM_MEDIA_KEYS_STEP, 0, 1),
+                                                       dir);
+        write->channels[i] = keys->channels[i];
+        write->volumes[i] = keys->volumes[i];
+    }
+
+    write->count = keys->n_channels;
+    write->dir = dir;
+    write->mute = -1;
+
+    gam_media_keys_post (keys, keys->volumes, write);
+}
+
+static void
+gam_media_keys_toggle_mute (GamMediaKeys *keys)
+{
+    GamMediaKeysWrite *write;
+
+    if (!keys->info->has_switch[PLAYBACK])
+        return;
+
+    if (g_atomic_int_get (&keys->in_flight) == 0 || keys->mute < 0)
+        keys->mute = gam_element_model_get_switch (keys->model, PLAYBACK, SND_MIXER_SCHN_FRONT_LEFT);
+
+    keys->mute = !keys->mute;
+
+    write = g_new0 (GamMediaKeysWrite, 1);
+    write->mute = keys->mute;
+
+    gam_media_keys_post (keys, &keys->mute, write);
+}
+
+static gboolean
+gam_media_keys_apply (gpointer data)
+{
+    GamMediaKeys * const keys = data;
+    const gint steps = keys->pending_steps;
+    const gboolean mute = keys->pending_mute;
+
+    keys->apply_id = 0;
+    keys->pending_steps = 0;
+    keys->pending_mute = FALSE;
+
+    if (keys->app == NULL)
+        return G_SOURCE_REMOVE;
+
+    if (!gam_media_keys_resolve (keys)) {
+        /* the presses wait for a mixer that is still being built */
+        if (gam_app_get_mixer_loading (keys->app, keys->card)) {
+            keys->pending_steps += steps;
+            keys->pending_mute ^= mute;
+        }
+        return G_SOURCE_REMOVE;
+    }
+
+    /* only the model is read here; the writer thread takes the lock */
+    if (steps != 0)
+        gam_media_keys_step_volume (keys, steps);
+    if (mute)
+        gam_media_keys_toggle_mute (keys);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+gam_media_keys_mixer_loaded_cb (GamApp *gam_app, const gchar *card, GamMediaKeys *keys)
+{
+    if (g_strcmp0 (card, keys->card) != 0)
+        return;
+
+    if (keys->apply_id == 0 && (keys->pending_steps != 0 || keys->pending_mute))
+        keys->apply_id = g_idle_add (gam_media_keys_apply, keys);
+}
+
+static GdkFilterReturn
+gam_media_keys_filter (GdkXEvent *gdk_xevent, GdkEvent *event, gpointer data)
+{
+    GamMediaKeys * const keys = data;
+    XEvent * const xevent = gdk_xevent;
+    const gboolean press = xevent->type == KeyPress;
+
+    if (xevent->type != KeyPress && xevent->type != KeyRelease)
+        return GDK_FILTER_CONTINUE;
+
+    if (xevent->xkey.keycode == keys->keycodes[KEY_RAISE]) {
+        if (press)
+            keys->pending_steps++;
+    } else if (xevent->xkey.keycode == keys->keycodes[KEY_LOWER]) {
+        if (press)
+            keys->pending_steps--;
+    } else if (xevent->xkey.keycode == keys->keycodes[KEY_MUTE]) {
+        /* a held mute key toggles once */
+        if (press && !keys->mute_down)
+            keys->pending_mute = !keys->pending_mute;
+        keys->mute_down = press;
+    } else
+        return GDK_FILTER_CONTINUE;
+
+    if (keys->apply_id == 0 && (keys->pending_steps != 0 || keys->pending_mute))
+        keys->apply_id = g_timeout_add (GAM_MEDIA_KEYS_DELAY, gam_media_keys_apply, keys);
+
+    return GDK_FILTER_REMOVE;
+}
+
+static void
+gam_media_keys_grab (GamMediaKeys *keys, gboolean grab)
+{
+    GdkDisplay * const display = gdk_display_get_default ();
+    Display * const xdisplay = GDK_DISPLAY_XDISPLAY (display);
+    const Window root = GDK_WINDOW_XID (gdk_get_default_root_window ());
+    guint key, i;
+
+    gdk_x11_display_error_trap_push (display);
+
+    for (key = 0; key < N_KEYS; key++) {
+        if (keys->keycodes[key] == 0)
+            continue;
+
+        for (i = 0; i < G_N_ELEMENTS (grab_modifiers); i++) {
+            if (grab)
+                XGrabKey (xdisplay, keys->keycodes[key], grab_modifiers[i], root,
+                          True, GrabModeAsync, GrabModeAsync);
+            else
+                XUngrabKey (xdisplay, keys->keycodes[key], grab_modifiers[i], root);
+        }
+    }
+
+    if (gdk_x11_display_error_trap_pop (display) != 0 && grab)
+        g_warning ("Some volume keys are grabbed by another program already");
+}
+
+/*
+ * Binds the volume keys to the playback volume and switch of 'elem_name'
+ * on 'card'.  The card does not need a tab yet; the keys do nothing until
+ * it has one, and presses made while its mixer is built are applied once it
+ * is.  The mixer is never unloaded meanwhile.  Returns NULL when the display
+ * is not an X11 one.
+ */
+GamMediaKeys *
+gam_media_keys_new (GamApp *gam_app, const gchar *card, const gchar *elem_name)
+{
+    GdkDisplay * const display = gdk_display_get_default ();
+    GamMediaKeys *keys;
+    guint key;
+
+    g_return_val_if_fail (GAM_IS_APP (gam_app), NULL);
+
+    if (!GDK_IS_X11_DISPLAY (display)) {
+        g_warning ("The volume keys can only be grabbed on X11");
+        return NULL;
+    }
+
+    keys = g_new0 (GamMediaKeys, 1);
+    keys->app = gam_app;
+    keys->card = g_strdup (card);
+    keys->elem_name = g_strdup (elem_name);
+    keys->mute = -1;
+
+    for (key = 0; key < N_KEYS; key++)
+        keys->keycodes[key] = XKeysymToKeycode (GDK_DISPLAY_XDISPLAY (display), key_syms[key]);
+
+    /* a held key repeats its presses only, without releases in between */
+    XkbSetDetectableAutoRepeat (GDK_DISPLAY_XDISPLAY (display), True, NULL);
+
+    gam_media_keys_grab (keys, TRUE);
+    gdk_window_add_filter (gdk_get_default_root_window (), gam_media_keys_filter, keys);
+
+    /* the window may be gone before the keys are freed */
+    g_object_add_weak_pointer (G_OBJECT (gam_app), (gpointer *) &keys->app);
+    gam_app_pin_mixer (gam_app, card);
+    keys->loaded_id = g_signal_connect (G_OBJECT (gam_app), "mixer_loaded",
+                                        G_CALLBACK (gam_media_keys_mixer_loaded_cb), keys);
+
+    return keys;
+}
+
+void
+gam_media_keys_free (GamMediaKeys *keys)
+{
+    if (keys == NULL)
+        return;
+
+    gdk_window_remove_filter (gdk_get_default_root_window (), gam_media_keys_filter, keys);
+    gam_media_keys_grab (keys, FALSE);
+
+    if (keys->apply_id)
+        g_source_remove (keys->apply_id);
+
+    if (keys->app != NULL) {
+        g_signal_handler_disconnect (G_OBJECT (keys->app), keys->loaded_id);
+        gam_app_unpin_mixer (keys->app, keys->card);
+        g_object_remove_weak_pointer (G_OBJECT (keys->app), (gpointer *) &keys->app);
+    }
+
+    gam_media_keys_release (keys);
+
+    g_free (keys->card);
+    g_free (keys->elem_name);
+    g_free (keys);
+}
+
+#endif /* HAVE_LIBX11 */
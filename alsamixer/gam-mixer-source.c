@@ -0,0 +1,334 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+/*
+ * One main loop source for the poll descriptors of all open mixers.  Every
+ * mixer handle brings its descriptors; after a poll, the revents are passed
+ * through snd_mixer_poll_descriptors_revents() and only the handles with
+ * events are dispatched, each once per main loop iteration.
+ *
+ * Normally the source runs in the default main context.  With
+ * gam_mixer_source_set_threaded(), it runs in a thread of its own instead,
+ * so the events are read however busy the GTK thread is; the callbacks then
+ * run in that thread.  The handle list is guarded by a lock that is also held
+ * while callbacks run, so once gam_mixer_source_remove() returns, no callback
+ * for that handle runs anymore.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gam-mixer-source.h"
+
+typedef struct
+{
+    snd_mixer_t        *handle;
+    GamMixerSourceFunc  func;
+    gpointer            data;
+
+    GPollFD            *fds;
+    struct pollfd      *pollfds;
+    guint               n_fds;
+
+    gushort             revents;
+    gboolean            removed;
+} GamMixerSourceHandle;
+
+typedef struct
+{
+    GSource  source;
+
+    GList   *handles;
+    gboolean dispatching;
+} GamMixerSource;
+
+static GamMixerSource *mixer_source = NULL;
+static GRecMutex       source_lock;
+static GMainContext   *source_context = NULL;
+static GThread        *source_thread = NULL;
+
+static void
+gam_mixer_source_handle_free (GamMixerSourceHandle *source_handle)
+{
+    g_free (source_handle->fds);
+    g_free (source_handle->pollfds);
+    g_free (source_handle);
+}
+
+static gboolean
+gam_mixer_source_prepare (GSource *source, gint *timeout)
+{
+    *timeout = -1;
+
+    return FALSE;
+}
+
+static gboolean
+gam_mixer_source_check (GSource *source)
+{
+    GamMixerSource * const gam_source = (GamMixerSource *) source;
+    gboolean ready = FALSE;
+    GList *l;
+
+    g_rec_mutex_lock (&source_lock);
+
+    for (l = gam_source->handles; l; l = l->next) {
+        GamMixerSourceHandle * const source_handle = l->data;
+        gushort revents = 0;
+        guint i;
+
+        source_handle->revents = 0;
+
+        for (i = 0; i < source_handle->n_fds; i++) {
+            source_handle->pollfds[i].revents = source_handle->fds[i].revents;
+            revents |= source_handle->fds[i].revents;
+        }
+        if (revents == 0)
+            continue;
+
+        if (snd_mixer_poll_descriptors_revents (source_handle->handle, source_handle->pollfds,
+                                                source_handle->n_fds, &revents) < 0)
+            revents = POLLERR;
+
+        /* errors and hangups are passed on even if ALSA folds them away */
+        for (i = 0; i < source_handle->n_fds; i++)
+            revents |= source_handle->fds[i].revents & (POLLERR | POLLHUP | POLLNVAL);
+
+        source_handle->revents = revents;
+        if (revents)
+            ready = TRUE;
+    }
+
+    g_rec_mutex_unlock (&source_lock);
+
+    return ready;
+}
+
+static gboolean
+gam_mixer_source_dispatch (GSource *source, GSourceFunc callback, gpointer user_data)
+{
+    GamMixerSource * const gam_source = (GamMixerSource *) source;
+    GList *l, *next;
+
+    g_rec_mutex_lock (&source_lock);
+
+    gam_source->dispatching = TRUE;
+
+    for (l = gam_source->handles; l; l = l->next) {
+        GamMixerSourceHandle * const source_handle = l->data;
+        const gushort revents = source_handle->revents;
+
+        source_handle->revents = 0;
+        if (revents == 0 || source_handle->removed)
+            continue;
+
+        if (!source_handle->func (source_handle->handle, revents, source_handle->data))
+            gam_mixer_source_remove (source_handle->handle);
+    }
+
+    gam_source->dispatching = FALSE;
+
+    /* handles removed by a callback were only marked while the list was walked */
+    for (l = gam_source->handles; l; l = next) {
+        GamMixerSourceHandle * const source_handle = l->data;
+
+        next = l->next;
+        if (source_handle->removed) {
+            gam_source->handles = g_list_delete_link (gam_source->handles, l);
+            gam_mixer_source_handle_free (source_handle);
+        }
+    }
+
+    if (gam_source->handles == NULL && mixer_source == gam_source) {
+        mixer_source = NULL;
+        g_source_destroy (source);
+        g_source_unref (source);
+    }
+
+    g_rec_mutex_unlock (&source_lock);
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+gam_mixer_source_finalize (GSource *source)
+{
+    GamMixerSource * const gam_source = (GamMixerSource *) source;
+
+    g_list_free_full (gam_source->handles, (GDestroyNotify) gam_mixer_source_handle_free);
+    gam_source->handles = NULL;
+}
+
+static GSourceFuncs gam_mixer_source_funcs = {
+    gam_mixer_source_prepare,
+    gam_mixer_source_check,
+    gam_mixer_source_dispatch,
+    gam_mixer_source_finalize,
+};
+
+static gpointer
+gam_mixer_source_thread (gpointer data)
+{
+    GMainLoop * const loop = data;
+
+    g_main_context_push_thread_default (source_context);
+    g_main_loop_run (loop);
+
+    return NULL;
+}
+
+/* to be called before the first handle is added */
+void
+gam_mixer_source_set_threaded (gboolean threaded)
+{
+    g_return_if_fail (mixer_source == NULL);
+
+    if (!threaded || source_thread != NULL)
+        return;
+
+    source_context = g_main_context_new ();
+    source_thread = g_thread_new ("gam-mixer-events", gam_mixer_source_thread,
+                                  g_main_loop_new (source_context, FALSE));
+}
+
+gboolean
+gam_mixer_source_is_threaded (void)
+{
+    return source_thread != NULL;
+}
+
+gboolean
+gam_mixer_source_add (snd_mixer_t *handle, GamMixerSourceFunc func, gpointer data)
+{
+    GamMixerSourceHandle *source_handle;
+    gint count, i;
+
+    g_return_val_if_fail (handle != NULL, FALSE);
+    g_return_val_if_fail (func != NULL, FALSE);
+
+    count = snd_mixer_poll_descriptors_count (handle);
+    if (count < 0)
+        return FALSE;
+
+    source_handle = g_new0 (GamMixerSourceHandle, 1);
+    source_handle->handle = handle;
+    source_handle->func = func;
+    source_handle->data = data;
+    source_handle->n_fds = count;
+    source_handle->fds = g_new0 (GPollFD, count);
+    source_handle->pollfds = g_new0 (struct pollfd, count);
+
+    if (snd_mixer_poll_descriptors (handle, source_handle->pollfds, count) != count) {
+        gam_mixer_source_handle_free (source_handle);
+        return FALSE;
+    }
+
+    g_rec_mutex_lock (&source_lock);
+
+    if (mixer_source == NULL) {
+        mixer_source = (GamMixerSource *) g_source_new (&gam_mixer_source_funcs, sizeof (GamMixerSource));
+        g_source_set_name ((GSource *) mixer_source, "gam-mixer");
+        g_source_set_priority ((GSource *) mixer_source, G_PRIORITY_HIGH);
+        g_source_attach ((GSource *) mixer_source, source_context);
+    }
+
+    for (i = 0; i < count; i++) {
+        source_handle->fds[i].fd = source_handle->pollfds[i].fd;
+        source_handle->fds[i].events = source_handle->pollfds[i].events;
+        g_source_add_poll ((GSource *) mixer_source, &source_handle->fds[i]);
+    }
+
+    mixer_source->handles = g_list_append (mixer_source->handles, source_handle);
+
+    g_rec_mutex_unlock (&source_lock);
+
+    return TRUE;
+}
+
+/*
+ * A paused handle is left out of the poll, errors and hangups aside, so a
+ * callback that cannot read the events now is not called again until the
+ * handle is resumed.
+ */
+void
+gam_mixer_source_set_paused (snd_mixer_t *handle, gboolean paused)
+{
+    GList *l;
+    guint i;
+
+    g_rec_mutex_lock (&source_lock);
+
+    for (l = mixer_source ? mixer_source->handles : NULL; l; l = l->next) {
+        GamMixerSourceHandle * const source_handle = l->data;
+
+        if (source_handle->handle != handle || source_handle->removed)
+            continue;
+
+        for (i = 0; i < source_handle->n_fds; i++)
+            source_handle->fds[i].events = paused ? 0 : source_handle->pollfds[i].events;
+    }
+
+    g_rec_mutex_unlock (&source_lock);
+
+    if (!paused)
+        g_main_context_wakeup (source_context);
+}
+
+void
+gam_mixer_source_remove (snd_mixer_t *handle)
+{
+    GamMixerSourceHandle *source_handle = NULL;
+    GList *l = NULL;
+    guint i;
+
+    g_rec_mutex_lock (&source_lock);
+
+    if (mixer_source != NULL) {
+        for (l = mixer_source->handles; l; l = l->next) {
+            source_handle = l->data;
+            if (source_handle->handle == handle && !source_handle->removed)
+                break;
+        }
+    }
+
+    if (l == NULL) {
+        g_rec_mutex_unlock (&source_lock);
+        return;
+    }
+
+    for (i = 0; i < source_handle->n_fds; i++)
+        g_source_remove_poll ((GSource *) mixer_source, &source_handle->fds[i]);
+    source_handle->removed = TRUE;
+
+    if (!mixer_source->dispatching) {
+        mixer_source->handles = g_list_delete_link (mixer_source->handles, l);
+        gam_mixer_source_handle_free (source_handle);
+
+        if (mixer_source->handles == NULL) {
+            g_source_destroy ((GSource *) mixer_source);
+            g_source_unref ((GSource *) mixer_source);
+            mixer_source = NULL;
+        }
+    }
+
+    g_rec_mutex_unlock (&source_lock);
+}
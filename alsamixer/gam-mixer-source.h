@@ -0,0 +1,50 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_MIXER_SOURCE_H__
+#define __GAM_MIXER_SOURCE_H__
+
+#include <alsa/asoundlib.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Called when 'handle' has events; 'revents' holds the poll events as ALSA
+ * translated them.  Returning FALSE removes the handle from the source.
+ */
+typedef gboolean (* GamMixerSourceFunc) (snd_mixer_t *handle,
+                                         gushort      revents,
+                                         gpointer     data);
+
+void     gam_mixer_source_set_threaded (gboolean threaded);
+gboolean gam_mixer_source_is_threaded  (void);
+
+gboolean gam_mixer_source_add    (snd_mixer_t        *handle,
+                                  GamMixerSourceFunc  func,
+                                  gpointer            data);
+void     gam_mixer_source_remove (snd_mixer_t        *handle);
+void     gam_mixer_source_set_paused (snd_mixer_t    *handle,
+                                      gboolean        paused);
+
+G_END_DECLS
+
+#endif /* __GAM_MIXER_SOURCE_H__ */
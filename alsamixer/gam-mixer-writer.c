@@ -0,0 +1,184 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+/*
+ * A thread that does the writes to the mixers, so that a slow device never
+ * holds up the GTK thread.  Every slot, usually one control of an element,
+ * holds at most one pending write: posting to a slot that still waits
+ * replaces what was there, so the writer always goes straight to the latest
+ * value.  Slots are written in the order they were first posted to.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gam-mixer-writer.h"
+
+typedef struct
+{
+    gpointer           owner;
+    GamMixerWriterFunc func;
+    gpointer           data;
+    GDestroyNotify     destroy;
+} GamMixerWriterMail;
+
+static GMutex      writer_lock;
+static GCond       writer_cond;
+static GThread    *writer_thread = NULL;
+/* slot -> GamMixerWriterMail */
+static GHashTable *writer_slots = NULL;
+static GQueue      writer_order = G_QUEUE_INIT;
+/* the owner of the write that is running */
+static gpointer    writer_busy = NULL;
+
+static void
+gam_mixer_writer_mail_free (GamMixerWriterMail *mail)
+{
+    if (mail->destroy)
+        mail->destroy (mail->data);
+    g_free (mail);
+}
+
+static gpointer
+gam_mixer_writer_thread (gpointer data)
+{
+    g_mutex_lock (&writer_lock);
+
+    for (;;) {
+        GamMixerWriterMail *mail;
+        gpointer slot;
+
+        while (g_queue_is_empty (&writer_order))
+            g_cond_wait (&writer_cond, &writer_lock);
+
+        slot = g_queue_pop_head (&writer_order);
+        mail = g_hash_table_lookup (writer_slots, slot);
+        g_hash_table_steal (writer_slots, slot);
+
+        writer_busy = mail->owner;
+        g_mutex_unlock (&writer_lock);
+
+        mail->func (mail->data);
+        gam_mixer_writer_mail_free (mail);
+
+        g_mutex_lock (&writer_lock);
+        writer_busy = NULL;
+        g_cond_broadcast (&writer_cond);
+    }
+
+    return NULL;
+}
+
+/*
+ * Queues 'func' to be called with 'data' on the writer thread, in place of
+ * whatever still waits in 'slot'.  'destroy' frees 'data' afterwards, or
+ * when the write is dropped.
+ */
+void
+gam_mixer_writer_post (gpointer           slot,
+                       gpointer           owner,
+                       GamMixerWriterFunc func,
+                       gpointer           data,
+                       GDestroyNotify     destroy)
+{
+    GamMixerWriterMail *mail, *old;
+
+    g_return_if_fail (slot != NULL);
+    g_return_if_fail (func != NULL);
+
+    mail = g_new (GamMixerWriterMail, 1);
+    mail->owner = owner;
+    mail->func = func;
+    mail->data = data;
+    mail->destroy = destroy;
+
+    g_mutex_lock (&writer_lock);
+
+    if (writer_thread == NULL) {
+        writer_slots = g_hash_table_new (NULL, NULL);
+        writer_thread = g_thread_new ("gam-mixer-writer", gam_mixer_writer_thread, NULL);
+    }
+
+    old = g_hash_table_lookup (writer_slots, slot);
+    g_hash_table_insert (writer_slots, slot, mail);
+    if (old == NULL) {
+        g_queue_push_tail (&writer_order, slot);
+        g_cond_broadcast (&writer_cond);
+    }
+
+    g_mutex_unlock (&writer_lock);
+
+    if (old != NULL)
+        gam_mixer_writer_mail_free (old);
+}
+
+static void
+gam_mixer_writer_remove (gpointer owner, gboolean wait)
+{
+    GSList *dropped = NULL;
+    GHashTableIter iter;
+    gpointer slot, mail;
+
+    g_mutex_lock (&writer_lock);
+
+    if (writer_slots == NULL) {
+        g_mutex_unlock (&writer_lock);
+        return;
+    }
+
+    g_hash_table_iter_init (&iter, writer_slots);
+    while (g_hash_table_iter_next (&iter, &slot, &mail)) {
+        if (((GamMixerWriterMail *) mail)->owner != owner)
+            continue;
+
+        g_queue_remove (&writer_order, slot);
+        g_hash_table_iter_steal (&iter);
+        dropped = g_slist_prepend (dropped, mail);
+    }
+
+    while (wait && writer_busy == owner)
+        g_cond_wait (&writer_cond, &writer_lock);
+
+    g_mutex_unlock (&writer_lock);
+
+    g_slist_free_full (dropped, (GDestroyNotify) gam_mixer_writer_mail_free);
+}
+
+/*
+ * Drops the waiting writes of 'owner', and waits for one that is running.
+ * Must not be called with a lock held that the writes take.
+ */
+void
+gam_mixer_writer_cancel (gpointer owner)
+{
+    gam_mixer_writer_remove (owner, TRUE);
+}
+
+/*
+ * Drops the waiting writes of 'owner' without waiting for one that is
+ * running, which must hold on to whatever it uses by itself.
+ */
+void
+gam_mixer_writer_drop (gpointer owner)
+{
+    gam_mixer_writer_remove (owner, FALSE);
+}
@@ -0,0 +1,41 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_MIXER_WRITER_H__
+#define __GAM_MIXER_WRITER_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef void (* GamMixerWriterFunc) (gpointer data);
+
+void gam_mixer_writer_post   (gpointer           slot,
+                              gpointer           owner,
+                              GamMixerWriterFunc func,
+                              gpointer           data,
+                              GDestroyNotify     destroy);
+void gam_mixer_writer_cancel (gpointer           owner);
+void gam_mixer_writer_drop   (gpointer           owner);
+
+G_END_DECLS
+
+#endif /* __GAM_MIXER_WRITER_H__ */
@@ -23,16 +23,27 @@
 #include <config.h>
 #endif
 
+#include <string.h>
+
 #include <glib/gi18n.h>
 
 #include "gam-mixer.h"
+#include "gam-mixer-source.h"
+#include "gam-event-queue.h"
+#include "gam-echo-filter.h"
+#include "gam-mixer-writer.h"
+#include "gam-history.h"
+#include "gam-element-model.h"
+#include "gam-element-registry.h"
 #include "gam-slider-pan.h"
 #include "gam-slider-dual.h"
+#include "gam-slider-multi.h"
 #include "gam-toggle.h"
 
 enum {
     DISPLAY_NAME_CHANGED,
     VISIBILITY_CHANGED,
+    DISCONNECTED,
     LAST_SIGNAL
 };
 
@@ -40,7 +51,8 @@ enum {
     PROP_0,
     PROP_APP,
     PROP_CARD_ID,
-    PROP_STYLE
+    PROP_STYLE,
+    PROP_CARD
 };
 
 struct _GamMixerPrivate
@@ -56,9 +68,26 @@ struct _GamMixerPrivate
 
     snd_mixer_t  *handle;
 
-    GList        *io_channels;
-    guint        *input_ids;
-    guint         input_id_count;
+    /* a card opened in the background, only until the constructor takes it over */
+    GamCard      *card;
+
+    /* held around every use of the handle and its elements: by whichever
+     * thread handles the events, and by the writes; the GTK thread only
+     * tries it, and leaves the events for later when a write has it
+     */
+    GRecMutex     handle_lock;
+    /* the GTK thread skipped the events; the writer resumes them once done */
+    gint          refresh_deferred;
+
+    /* the element table, its subscribers and the dirty sets; the event
+     * thread never takes it, and it is never held across a handle call
+     */
+    GRecMutex     lock;
+
+    /* with an event thread: its element events, handed over to the frame tick */
+    GamEventQueue *queue;
+    GSource      *handoff;
+    gint          handoff_pending;
 
     gchar        *card_id;
     gchar        *card_name;
@@ -66,8 +95,69 @@ struct _GamMixerPrivate
     gchar        *mixer_name_config;
 
     gchar        *style;
+
+    /* what there is to know about every element, for the life of the mixer */
+    GamElementRegistry *registry;
+
+    /* element -> GamMixerElem */
+    GHashTable   *elems;
+
+    /* elements whose model changed since the last frame */
+    GHashTable   *dirty;
+    GHashTable   *draining;
+    guint         tick_id;
+
+    /* not on screen: events only pile up in 'dirty' until it is shown again */
+    gboolean      parked;
+
+    guint64       refresh_events;
+    guint64       refresh_updates;
+    guint64       refresh_frames;
+    /* counted by whichever thread handles the events */
+    gint          refresh_echoes;
+    guint64       refresh_throttled;
+
+    GamHistory   *history;
 };
 
+typedef struct
+{
+    snd_mixer_elem_t    *elem;
+    GtkWidget           *view;
+    GamMixerRefreshFunc  refresh;
+} GamMixerSubscriber;
+
+typedef struct
+{
+    GamMixer          *mixer;
+    const GamElementInfo *info;
+    GSList            *subscribers;
+
+    /* the values all views of the element read, and the signals they follow */
+    GamElementModel   *model;
+
+    /* set by the event thread; the views learn of it with the next frame */
+    gint               removed;
+
+    /* our own writes, to recognise the events that only echo them */
+    GamEchoFilter      echo;
+
+    /* event rate, over windows of a second */
+    guint64            events;
+    gint64             window_start;
+    guint              window_events;
+    gdouble            rate;
+
+    /* frame time of the last view update, and the updates held back */
+    gint64             last_update;
+    guint64            throttled;
+} GamMixerElem;
+
+/* an element sending more events per second than this is rate limited ... */
+#define GAM_MIXER_STORM_RATE  30
+/* ... to this many view updates per second */
+#define GAM_MIXER_STORM_UPDATES 10
+
 static void     gam_mixer_finalize           (GObject               *object);
 static GObject *gam_mixer_constructor        (GType                  type,
                                               guint                  n_construct_properties,
@@ -81,10 +171,40 @@ static void     gam_mixer_get_property       (GObject               *object,
                                               GValue                *value,
                                               GParamSpec            *pspec);
 static void     gam_mixer_construct_elements (GamMixer              *gam_mixer);
-static void     gam_mixer_construct_sliders  (GamMixer              *gam_mixer);
-static gboolean gam_mixer_refresh            (GIOChannel            *source,
-                                              GIOCondition           condition,
+static gboolean gam_mixer_refresh            (snd_mixer_t           *handle,
+                                              gushort                revents,
                                               gpointer               data);
+static gint     gam_mixer_event              (snd_mixer_t           *handle,
+                                              guint                  mask,
+                                              snd_mixer_elem_t      *elem);
+static gint     gam_mixer_elem_event         (snd_mixer_elem_t      *elem,
+                                              guint                  mask);
+static void     gam_mixer_elem_free          (GamMixerElem          *mixer_elem);
+static void     gam_mixer_dispatch_event     (GamMixer              *gam_mixer,
+                                              snd_mixer_elem_t      *elem,
+                                              guint                  mask);
+static gboolean gam_mixer_handoff            (gpointer               data);
+static gboolean gam_mixer_tick               (GtkWidget             *widget,
+                                              GdkFrameClock         *frame_clock,
+                                              gpointer               data);
+static void     gam_mixer_schedule_tick      (GamMixer              *gam_mixer);
+
+static gboolean gam_mixer_handoff_dispatch   (GSource               *source,
+                                              GSourceFunc            callback,
+                                              gpointer               data);
+
+/* events the event thread may get ahead of the frames by */
+#define GAM_MIXER_EVENT_QUEUE_SIZE 256
+
+/* changes a card can undo */
+#define GAM_MIXER_HISTORY_SIZE 100
+
+static GSourceFuncs gam_mixer_handoff_funcs = {
+    NULL,
+    NULL,
+    gam_mixer_handoff_dispatch,
+    NULL,
+};
 
 static gpointer parent_class;
 static guint signals[LAST_SIGNAL] = { 0 };
@@ -122,6 +242,15 @@ gam_mixer_class_init (GamMixerClass *klass)
                       g_cclosure_marshal_VOID__VOID,
                       G_TYPE_NONE, 0);
 
+    signals[DISCONNECTED] =
+        g_signal_new ("disconnected",
+                      G_OBJECT_CLASS_TYPE (widget_class),
+                      G_SIGNAL_RUN_FIRST,
+                      G_STRUCT_OFFSET (GamMixerClass, disconnected),
+                      NULL, NULL,
+                      g_cclosure_marshal_VOID__VOID,
+                      G_TYPE_NONE, 0);
+
     g_object_class_install_property (gobject_class,
                                      PROP_APP,
                                      g_param_spec_pointer ("app",
@@ -144,6 +273,13 @@ gam_mixer_class_init (GamMixerClass *klass)
                                                         _("Style"),
                                                         NULL,
                                                         (GParamFlags) (G_PARAM_READWRITE | G_PARAM_CONSTRUCT)));
+
+    g_object_class_install_property (gobject_class,
+                                     PROP_CARD,
+                                     g_param_spec_pointer ("card",
+                                                           _("Card"),
+                                                           _("Card already opened by gam_card_load_async ()"),
+                                                           (GParamFlags) (G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY)));
 }
 
 static void
@@ -165,8 +301,23 @@ gam_mixer_init (GamMixer *gam_mixer)
     gam_mixer->priv->mixer_name = NULL;
     gam_mixer->priv->mixer_name_config = NULL;
     gam_mixer->priv->handle = NULL;
-    gam_mixer->priv->input_id_count = 0;
-    gam_mixer->priv->input_ids = NULL;
+    gam_mixer->priv->card = NULL;
+    g_rec_mutex_init (&gam_mixer->priv->handle_lock);
+    g_rec_mutex_init (&gam_mixer->priv->lock);
+    gam_mixer->priv->queue = NULL;
+    gam_mixer->priv->handoff = NULL;
+    gam_mixer->priv->handoff_pending = FALSE;
+    gam_mixer->priv->elems = g_hash_table_new (NULL, NULL);
+    gam_mixer->priv->dirty = g_hash_table_new (NULL, NULL);
+    gam_mixer->priv->draining = g_hash_table_new (NULL, NULL);
+    gam_mixer->priv->tick_id = 0;
+    gam_mixer->priv->parked = FALSE;
+    gam_mixer->priv->refresh_events = 0;
+    gam_mixer->priv->refresh_updates = 0;
+    gam_mixer->priv->refresh_frames = 0;
+    gam_mixer->priv->refresh_echoes = 0;
+    gam_mixer->priv->refresh_throttled = 0;
+    gam_mixer->priv->history = gam_history_new (GAM_MIXER_HISTORY_SIZE);
 
     gam_mixer->priv->pan_size_group = gtk_size_group_new (GTK_SIZE_GROUP_BOTH);
     gam_mixer->priv->mute_size_group = gtk_size_group_new (GTK_SIZE_GROUP_BOTH);
@@ -199,35 +350,72 @@ static void
 gam_mixer_finalize (GObject *object)
 {
     GamMixer *gam_mixer = GAM_MIXER (object);
-    guint input_id;
+    GHashTableIter iter;
+    gpointer elem, mixer_elem;
+
+    /* waits for the event thread to be done with the handle */
+    gam_mixer_source_remove (gam_mixer->priv->handle);
 
-    for (input_id = 0; input_id < gam_mixer->priv->input_id_count; ++input_id)
-        g_source_remove (gam_mixer->priv->input_ids[input_id]);
-    g_list_free_full (gam_mixer->priv->io_channels, (void (*) (void*)) g_io_channel_unref);
+    /* and for an undo, or the start of a gesture, that is being written */
+    gam_mixer_writer_cancel (gam_mixer);
+    gam_history_free (gam_mixer->priv->history);
+    gam_mixer->priv->history = NULL;
+
+    if (gam_mixer->priv->handoff) {
+        g_source_destroy (gam_mixer->priv->handoff);
+        g_source_unref (gam_mixer->priv->handoff);
+        gam_event_queue_free (gam_mixer->priv->queue);
+    }
+
+    g_debug ("%s: %" G_GUINT64_FORMAT " element events, %" G_GUINT64_FORMAT " widget updates in %"
+             G_GUINT64_FORMAT " frames, %" G_GUINT64_FORMAT " echoes of our own writes dropped, %"
+             G_GUINT64_FORMAT " updates held back by rate limiting",
+             gam_mixer->priv->card_id, gam_mixer->priv->refresh_events, gam_mixer->priv->refresh_updates,
+             gam_mixer->priv->refresh_frames, (guint64) gam_mixer->priv->refresh_echoes,
+             gam_mixer->priv->refresh_throttled);
+
+    /* closing the mixer removes the elements, which must not call back into us */
+    g_hash_table_iter_init (&iter, gam_mixer->priv->elems);
+    while (g_hash_table_iter_next (&iter, &elem, &mixer_elem)) {
+        if (!((GamMixerElem *) mixer_elem)->removed)
+            snd_mixer_elem_set_callback (elem, NULL);
+        gam_mixer_elem_free (mixer_elem);
+    }
+    g_hash_table_destroy (gam_mixer->priv->elems);
+    gam_element_registry_free (gam_mixer->priv->registry);
+    gam_mixer->priv->registry = NULL;
+    g_hash_table_destroy (gam_mixer->priv->dirty);
+    g_hash_table_destroy (gam_mixer->priv->draining);
 
     g_free (gam_mixer->priv->card_id);
     g_free (gam_mixer->priv->card_name);
     g_free (gam_mixer->priv->mixer_name);
     g_free (gam_mixer->priv->mixer_name_config);
     g_free (gam_mixer->priv->style);
-    g_free (gam_mixer->priv->input_ids);
     g_object_unref (gam_mixer->priv->capture_size_group);
     g_object_unref (gam_mixer->priv->mute_size_group);
     g_object_unref (gam_mixer->priv->pan_size_group);
 
-    snd_mixer_close (gam_mixer->priv->handle);
+    gam_card_close (gam_mixer->priv->handle);
 
     gam_mixer->priv->handle = NULL;
     gam_mixer->priv->app = NULL;
     gam_mixer->priv->card_id = NULL;
     gam_mixer->priv->card_name = NULL;
     gam_mixer->priv->mixer_name = NULL;
-    gam_mixer->priv->input_ids = NULL;
+    gam_mixer->priv->elems = NULL;
+    gam_mixer->priv->dirty = NULL;
+    gam_mixer->priv->draining = NULL;
     gam_mixer->priv->slider_box = NULL;
     gam_mixer->priv->toggle_box = NULL;
     gam_mixer->priv->pan_size_group = NULL;
     gam_mixer->priv->mute_size_group = NULL;
     gam_mixer->priv->capture_size_group = NULL;
+    gam_mixer->priv->handoff = NULL;
+    gam_mixer->priv->queue = NULL;
+
+    g_rec_mutex_clear (&gam_mixer->priv->lock);
+    g_rec_mutex_clear (&gam_mixer->priv->handle_lock);
 
     G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -237,13 +425,8 @@ gam_mixer_constructor (GType                  type,
                        guint                  n_construct_properties,
                        GObjectConstructParam *construct_params)
 {
-    snd_ctl_card_info_t *hw_info;
-    snd_ctl_t *ctl_handle;
     GObject *object;
     GamMixer *gam_mixer;
-    gint err, poll_count, poll_fill_count, input_id;
-    guint *input_ids;
-    struct pollfd *polls;
 
     object = (* G_OBJECT_CLASS (parent_class)->constructor) (type,
                                                              n_construct_properties,
@@ -251,64 +434,38 @@ gam_mixer_constructor (GType                  type,
 
     gam_mixer = GAM_MIXER (object);
 
-    snd_ctl_card_info_alloca (&hw_info);
-
-    err = snd_ctl_open (&ctl_handle, gam_mixer->priv->card_id, 0);
-    if (err != 0) return NULL;
-
-    err = snd_ctl_card_info (ctl_handle, hw_info);
-    if (err != 0) return NULL;
-
-    snd_ctl_close (ctl_handle);
-
-    err = snd_mixer_open (&gam_mixer->priv->handle, 0);
-    if (err != 0) return NULL;
-
-    err = snd_mixer_attach (gam_mixer->priv->handle, gam_mixer->priv->card_id);
-    if (err != 0) return NULL;
-
-    err = snd_mixer_selem_register (gam_mixer->priv->handle, NULL, NULL);
-    if (err != 0) return NULL;
-
-    err = snd_mixer_load (gam_mixer->priv->handle);
-    if (err != 0) return NULL;
-
-    gam_mixer->priv->card_name = g_strdup (snd_ctl_card_info_get_name (hw_info));
-    gam_mixer->priv->mixer_name = g_strdup (snd_ctl_card_info_get_mixername (hw_info));
+    if (gam_mixer->priv->card) {
+        GamCard * const card = gam_mixer->priv->card;
+
+        gam_mixer->priv->handle = card->handle;
+        gam_mixer->priv->card_name = card->card_name;
+        gam_mixer->priv->mixer_name = card->mixer_name;
+        card->handle = NULL;
+        card->card_name = NULL;
+        card->mixer_name = NULL;
+        gam_mixer->priv->card = NULL;
+    } else {
+        gam_mixer->priv->handle = gam_card_open (gam_mixer->priv->card_id,
+                                                 &gam_mixer->priv->card_name,
+                                                 &gam_mixer->priv->mixer_name);
+    }
+    if (gam_mixer->priv->handle == NULL) return NULL;
 
+    gam_mixer->priv->registry = gam_element_registry_new (gam_mixer->priv->handle, GAM_CONFIG_DELIMITERS);
     gam_mixer_construct_elements (gam_mixer);
 
-    poll_count = snd_mixer_poll_descriptors_count (gam_mixer->priv->handle);
-    if (poll_count < 0) return NULL;
-
-    polls = g_newa (struct pollfd, poll_count);
-    poll_fill_count = snd_mixer_poll_descriptors (gam_mixer->priv->handle, polls, poll_count);
-    if (poll_count != poll_fill_count) return NULL;
-    
-    input_ids = g_new (guint, poll_count);
-
-    for (input_id = 0; input_id < poll_count; ++input_id) {
-        GIOChannel  *channel;
-        GIOCondition condition = 0;
-        const struct pollfd * const pollfd = &polls[input_id];
-        const short  events = pollfd->events;
+    snd_mixer_set_callback_private (gam_mixer->priv->handle, gam_mixer);
+    snd_mixer_set_callback (gam_mixer->priv->handle, gam_mixer_event);
 
-        if (events & POLLIN)
-            condition |= G_IO_IN;
-        if (events & POLLOUT)
-            condition |= G_IO_OUT;
-        if (events & POLLPRI)
-            condition |= G_IO_PRI;
-
-        channel = g_io_channel_unix_new (pollfd->fd);
-        input_ids[input_id] = g_io_add_watch_full (channel, G_PRIORITY_HIGH, condition,
-                                                   gam_mixer_refresh, gam_mixer,
-                                                   NULL);
-        gam_mixer->priv->io_channels = g_list_prepend (gam_mixer->priv->io_channels, channel);
+    if (gam_mixer_source_is_threaded ()) {
+        gam_mixer->priv->queue = gam_event_queue_new (GAM_MIXER_EVENT_QUEUE_SIZE);
+        gam_mixer->priv->handoff = g_source_new (&gam_mixer_handoff_funcs, sizeof (GSource));
+        g_source_set_name (gam_mixer->priv->handoff, "gam-mixer-handoff");
+        g_source_set_callback (gam_mixer->priv->handoff, gam_mixer_handoff, gam_mixer, NULL);
+        g_source_attach (gam_mixer->priv->handoff, NULL);
     }
 
-    gam_mixer->priv->input_ids = input_ids;
-    gam_mixer->priv->input_id_count = (guint) poll_count;
+    if (!gam_mixer_source_add (gam_mixer->priv->handle, gam_mixer_refresh, gam_mixer)) return NULL;
 
     return object;
 }
@@ -338,6 +495,9 @@ gam_mixer_set_property (GObject      *object,
             gam_mixer->priv->style = g_strdup (g_value_get_string (value));
             g_object_notify (G_OBJECT (gam_mixer), "style");
             break;
+        case PROP_CARD:
+            gam_mixer->priv->card = g_value_get_pointer (value);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
             break;
@@ -370,119 +530,110 @@ gam_mixer_get_property (GObject    *object,
     }
 }
 
-static void
-gam_mixer_construct_elements (GamMixer *gam_mixer)
+/* the strip for one direction of an element, in the style of the mixer */
+static GtkWidget *
+gam_mixer_new_slider (GamMixer *gam_mixer, const GamElementInfo *info, gboolean playback)
 {
-    GtkWidget *toggle, *vbox = NULL;
-    snd_mixer_elem_t *elem;
-    gint i = 0;
+    GtkWidget *slider;
 
-    gam_mixer_construct_sliders (gam_mixer);
-
-    for (elem = snd_mixer_first_elem (gam_mixer->priv->handle); elem; elem = snd_mixer_elem_next (elem)) {
-        if (snd_mixer_selem_is_active (elem)) {
-            if (snd_mixer_selem_is_enumerated (elem) == FALSE) {
-                /* if element is a switch */
-                if (!(snd_mixer_selem_has_playback_volume (elem) || snd_mixer_selem_has_capture_volume (elem))) {
-                    if (i % 5 == 0) {
-                        vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
-                        gtk_box_pack_start (GTK_BOX (gam_mixer->priv->toggle_box),
-                                            vbox, TRUE, TRUE, 0);
-                        gtk_widget_show (vbox);
-                    }
-
-                    toggle = gam_toggle_new (elem, gam_mixer, GAM_APP (gam_mixer->priv->app));
-                    gtk_box_pack_start (GTK_BOX (vbox),
-                                        toggle, FALSE, FALSE, 0);
-                    if (gam_toggle_get_visible (GAM_TOGGLE (toggle)))
-                        gtk_widget_show (toggle);
-
-                    i++;
-                }
-            } else {
-                // TODO: enumerated controls
-            }
-        }
+    if (GAM_ELEMENT_INFO_IS_SURROUND (info, playback ? PLAYBACK : CAPTURE)) {
+        slider = gam_slider_multi_new (info->elem, gam_mixer, playback);
+        gam_slider_multi_set_size_groups (GAM_SLIDER_MULTI (slider),
+                                          gam_mixer->priv->pan_size_group,
+                                          gam_mixer->priv->mute_size_group,
+                                          gam_mixer->priv->capture_size_group);
+    } else if (g_strcmp0 (gam_mixer->priv->style, "DUAL") == 0) {
+        slider = gam_slider_dual_new (info->elem, gam_mixer, playback);
+        gam_slider_dual_set_size_groups (GAM_SLIDER_DUAL (slider),
+                                         gam_mixer->priv->pan_size_group,
+                                         gam_mixer->priv->mute_size_group,
+                                         gam_mixer->priv->capture_size_group);
+    } else {
+        slider = gam_slider_pan_new (info->elem, gam_mixer, playback);
+        gam_slider_pan_set_size_groups (GAM_SLIDER_PAN (slider),
+                                        gam_mixer->priv->pan_size_group,
+                                        gam_mixer->priv->mute_size_group,
+                                        gam_mixer->priv->capture_size_group);
     }
+
+    return slider;
 }
 
-void
-gam_mixer_construct_sliders (GamMixer *gam_mixer)
+static void
+gam_mixer_add_slider (GamMixer *gam_mixer, GtkWidget *box, const GamElementInfo *info, gboolean playback)
 {
-    GtkWidget *playback_frame;
-    GtkWidget *capture_frame;
-    GtkWidget *box;
-    GtkWidget *slider;
-    GtkWidget *separator;
-    snd_mixer_elem_t *elem;
+    GtkWidget *slider, *separator;
 
-    g_return_if_fail (GAM_IS_MIXER (gam_mixer));
+    slider = gam_mixer_new_slider (gam_mixer, info, playback);
+    gtk_box_pack_start (GTK_BOX (box), slider, TRUE, TRUE, 0);
 
-    /* playback */
-    playback_frame = gtk_frame_new ("Playback");
-    gtk_box_pack_start (GTK_BOX (gam_mixer->priv->slider_box), playback_frame, TRUE, TRUE, 5);
+    separator = gtk_separator_new (GTK_ORIENTATION_VERTICAL);
+    gtk_box_pack_start (GTK_BOX (box), separator, FALSE, FALSE, 0);
 
-    box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
-    gtk_container_add (GTK_CONTAINER (playback_frame), box);
-
-    for (elem = snd_mixer_first_elem (gam_mixer->priv->handle); elem; elem = snd_mixer_elem_next (elem)) {
-        if (snd_mixer_selem_is_active (elem)) {
-            if (snd_mixer_selem_has_playback_volume (elem)) {
-                if (g_strcmp0 (gam_mixer->priv->style, "DUAL") == 0) {
-                    slider = gam_slider_dual_new (elem, gam_mixer, TRUE);
-                    gam_slider_dual_set_size_groups (GAM_SLIDER_DUAL (slider),
-                                                     gam_mixer->priv->pan_size_group,
-                                                     gam_mixer->priv->mute_size_group,
-                                                     gam_mixer->priv->capture_size_group);
-                } else {
-                    slider = gam_slider_pan_new (elem, gam_mixer, TRUE);
-                    gam_slider_pan_set_size_groups (GAM_SLIDER_PAN (slider),
-                                                    gam_mixer->priv->pan_size_group,
-                                                    gam_mixer->priv->mute_size_group,
-                                                    gam_mixer->priv->capture_size_group);
-                }
-                gtk_box_pack_start (GTK_BOX (box), slider, TRUE, TRUE, 0);
-
-                separator = gtk_separator_new (GTK_ORIENTATION_VERTICAL);
-                gtk_box_pack_start (GTK_BOX (box), separator, FALSE, FALSE, 0);
-
-                if (gam_slider_get_visible (GAM_SLIDER (slider)))
-                    gtk_widget_show (slider);
-            }
-        }
-    }
+    if (gam_slider_get_visible (GAM_SLIDER (slider)))
+        gtk_widget_show (slider);
+}
+
+static GtkWidget *
+gam_mixer_new_slider_box (GamMixer *gam_mixer, const gchar *title)
+{
+    GtkWidget *frame, *box;
 
-    /* playback */
-    capture_frame = gtk_frame_new ("Capture");
-    gtk_box_pack_start (GTK_BOX (gam_mixer->priv->slider_box), capture_frame, TRUE, TRUE, 5);
+    frame = gtk_frame_new (title);
+    gtk_box_pack_start (GTK_BOX (gam_mixer->priv->slider_box), frame, TRUE, TRUE, 5);
 
     box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
-    gtk_container_add (GTK_CONTAINER (capture_frame), box);
-
-    for (elem = snd_mixer_first_elem (gam_mixer->priv->handle); elem; elem = snd_mixer_elem_next (elem)) {
-        if (snd_mixer_selem_is_active (elem)) {
-            if (snd_mixer_selem_has_capture_volume (elem)) {
-                if (g_strcmp0 (gam_mixer->priv->style, "DUAL") == 0) {
-                    slider = gam_slider_dual_new (elem, gam_mixer, FALSE);
-                    gam_slider_dual_set_size_groups (GAM_SLIDER_DUAL (slider),
-                                                     gam_mixer->priv->pan_size_group,
-                                                     gam_mixer->priv->mute_size_group,
-                                                     gam_mixer->priv->capture_size_group);
-                } else {
-                    slider = gam_slider_pan_new (elem, gam_mixer, FALSE);
-                    gam_slider_pan_set_size_groups (GAM_SLIDER_PAN (slider),
-                                                    gam_mixer->priv->pan_size_group,
-                                                    gam_mixer->priv->mute_size_group,
-                                                    gam_mixer->priv->capture_size_group);
-                }
-                gtk_box_pack_start (GTK_BOX (box), slider, TRUE, TRUE, 0);
-
-                separator = gtk_separator_new (GTK_ORIENTATION_VERTICAL);
-                gtk_box_pack_start (GTK_BOX (box), separator, FALSE, FALSE, 0);
-
-                if (gam_slider_get_visible (GAM_SLIDER (slider)))
-                    gtk_widget_show (slider);
+    gtk_container_add (GTK_CONTAINER (frame), box);
+
+    return box;
+}
+
+/*
+ * One pass over the registry builds the playback and capture strips and
+ * the switches; each box keeps the order of the element list.
+ */
+static void
+gam_mixer_construct_elements (GamMixer *gam_mixer)
+{
+    GtkWidget *playback_box, *capture_box, *toggle, *vbox = NULL;
+    const GamElementInfo *info;
+    guint n;
+    gint i = 0;
+
+    playback_box = gam_mixer_new_slider_box (gam_mixer, "Playback");
+    capture_box = gam_mixer_new_slider_box (gam_mixer, "Capture");
+
+    for (n = 0; n < gam_element_registry_get_count (gam_mixer->priv->registry); n++) {
+        info = gam_element_registry_get_nth (gam_mixer->priv->registry, n);
+        if (!info->active)
+            continue;
+
+        if (info->has_volume[PLAYBACK])
+            gam_mixer_add_slider (gam_mixer, playback_box, info, TRUE);
+        if (info->has_volume[CAPTURE])
+            gam_mixer_add_slider (gam_mixer, capture_box, info, FALSE);
+
+        if (info->enumerated) {
+            // TODO: enumerated controls
+            continue;
+        }
+
+        /* if element is a switch */
+        if (!(info->has_volume[PLAYBACK] || info->has_volume[CAPTURE])) {
+            if (i % 5 == 0) {
+                vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+                gtk_box_pack_start (GTK_BOX (gam_mixer->priv->toggle_box),
+                                    vbox, TRUE, TRUE, 0);
+                gtk_widget_show (vbox);
             }
+
+            toggle = gam_toggle_new (info->elem, gam_mixer, GAM_APP (gam_mixer->priv->app));
+            gtk_box_pack_start (GTK_BOX (vbox),
+                                toggle, FALSE, FALSE, 0);
+            if (gam_toggle_get_visible (GAM_TOGGLE (toggle)))
+                gtk_widget_show (toggle);
+
+            i++;
         }
     }
 }
@@ -497,6 +648,20 @@ gam_mixer_new (GamApp *gam_app, const gchar *card_id, const gchar *style)
                          NULL);
 }
 
+/* takes over the handle and names of 'card', which must have been opened */
+GtkWidget *
+gam_mixer_new_for_card (GamApp *gam_app, GamCard *card, const gchar *style)
+{
+    g_return_val_if_fail (card != NULL && card->handle != NULL, NULL);
+
+    return g_object_new (GAM_TYPE_MIXER,
+                         "app", gam_app,
+                         "card_id", card->card_id,
+                         "style", style,
+                         "card", card,
+                         NULL);
+}
+
 const gchar *
 gam_mixer_get_mixer_name (GamMixer *gam_mixer)
 {
@@ -510,10 +675,10 @@ gam_mixer_get_config_name (GamMixer *gam_mixer)
 {
     g_return_val_if_fail (GAM_IS_MIXER (gam_mixer), NULL);
 
-//    if (gam_mixer->priv->mixer_name_config == NULL) {
+    if (gam_mixer->priv->mixer_name_config == NULL) {
         gam_mixer->priv->mixer_name_config = g_strdup (gam_mixer_get_mixer_name (gam_mixer));
         gam_mixer->priv->mixer_name_config = g_strdelimit (gam_mixer->priv->mixer_name_config, GAM_CONFIG_DELIMITERS, '_');
- //   }
+    }
 
     return gam_mixer->priv->mixer_name_config;
 }
@@ -553,13 +718,1058 @@ gam_mixer_set_visible (GamMixer *gam_mixer, gboolean visible)
 }
 
 static gboolean
-gam_mixer_refresh (GIOChannel   *source,
-                   GIOCondition  condition,
-                   gpointer      data)
+gam_mixer_disconnected (gpointer data)
+{
+    g_signal_emit (G_OBJECT (data), signals[DISCONNECTED], 0);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* on the GTK thread, after a write let go of the handle */
+static gboolean
+gam_mixer_resume_events (gpointer data)
+{
+    GamMixer * const gam_mixer = GAM_MIXER (data);
+
+    if (gam_mixer->priv->handle != NULL)
+        gam_mixer_source_set_paused (gam_mixer->priv->handle, FALSE);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * Without an event thread, the events are handled on the GTK thread, which
+ * must not wait for a write that holds the handle across its ioctl.  While
+ * one does, the handle is left out of the poll; the writer puts it back
+ * when it lets go, and the events are read then.
+ */
+static gboolean
+gam_mixer_try_lock_events (GamMixer *gam_mixer)
+{
+    if (g_rec_mutex_trylock (&gam_mixer->priv->handle_lock))
+        return TRUE;
+
+    g_atomic_int_set (&gam_mixer->priv->refresh_deferred, TRUE);
+    gam_mixer_source_set_paused (gam_mixer->priv->handle, TRUE);
+
+    /* the write may have been done before it could see the flag */
+    if (!g_rec_mutex_trylock (&gam_mixer->priv->handle_lock))
+        return FALSE;
+
+    g_atomic_int_set (&gam_mixer->priv->refresh_deferred, FALSE);
+    gam_mixer_source_set_paused (gam_mixer->priv->handle, FALSE);
+
+    return TRUE;
+}
+
+static gboolean
+gam_mixer_refresh (snd_mixer_t *handle,
+                   gushort      revents,
+                   gpointer     data)
+{
+    GamMixer * const gam_mixer = GAM_MIXER (data);
+
+    /*
+     * The card is gone; its descriptors would only keep waking us up.  The
+     * signal goes out from the main loop, as this may run on the event thread
+     * and the handler will most likely destroy us.
+     */
+    if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        g_message ("%s: lost the connection to the mixer", gam_mixer->priv->card_id);
+        g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, gam_mixer_disconnected,
+                         g_object_ref (gam_mixer), g_object_unref);
+        return FALSE;
+    }
+
+    if (gam_mixer_source_is_threaded ())
+        g_rec_mutex_lock (&gam_mixer->priv->handle_lock);
+    else if (!gam_mixer_try_lock_events (gam_mixer))
+        return TRUE;
+
+    snd_mixer_handle_events (handle);
+    g_rec_mutex_unlock (&gam_mixer->priv->handle_lock);
+
+    return TRUE;
+}
+
+/* the model outlives us in the views that hold it, but no longer follows the element */
+static void
+gam_mixer_elem_free (GamMixerElem *mixer_elem)
+{
+    g_slist_free_full (mixer_elem->subscribers, g_free);
+
+    gam_element_model_detach (mixer_elem->model);
+    g_object_unref (mixer_elem->model);
+
+    g_free (mixer_elem);
+}
+
+/*
+ * Every view of an element subscribes here; the mixer owns the element
+ * callback and applies its events to the element's model, which signals the
+ * views once a frame with all changes since the last one.  'refresh' is
+ * only called for a removal, at once, as the element goes away right after
+ * it.  Once subscribed to, an element keeps its callback and model until it
+ * is removed or the mixer goes, so that neither is freed under a write.
+ */
+void
+gam_mixer_subscribe (GamMixer            *gam_mixer,
+                     snd_mixer_elem_t    *elem,
+                     GtkWidget           *view,
+                     GamMixerRefreshFunc  refresh)
+{
+    GamMixerSubscriber *subscriber;
+    GamMixerElem *mixer_elem;
+    GSList *l;
+
+    g_return_if_fail (GAM_IS_MIXER (gam_mixer));
+    g_return_if_fail (elem != NULL);
+
+    /*
+     * The callback is set while no event is handled.  Without an event thread
+     * that is this thread already, and it does not wait for the writes.
+     */
+    if (gam_mixer_source_is_threaded ())
+        g_rec_mutex_lock (&gam_mixer->priv->handle_lock);
+    g_rec_mutex_lock (&gam_mixer->priv->lock);
+
+    mixer_elem = g_hash_table_lookup (gam_mixer->priv->elems, elem);
+    if (mixer_elem == NULL) {
+        mixer_elem = g_new0 (GamMixerElem, 1);
+        mixer_elem->mixer = gam_mixer;
+        gam_echo_filter_init (&mixer_elem->echo);
+        mixer_elem->info = gam_element_registry_lookup (gam_mixer->priv->registry, elem);
+        mixer_elem->model = gam_element_model_new (mixer_elem->info, gam_app_get_volume_curve ());
+        g_hash_table_insert (gam_mixer->priv->elems, elem, mixer_elem);
+
+        snd_mixer_elem_set_callback_private (elem, mixer_elem);
+        snd_mixer_elem_set_callback (elem, gam_mixer_elem_event);
+    }
+
+    for (l = mixer_elem->subscribers; l; l = l->next) {
+        subscriber = l->data;
+        if (subscriber->view == view) {
+            subscriber->refresh = refresh;
+            break;
+        }
+    }
+
+    if (l == NULL) {
+        subscriber = g_new (GamMixerSubscriber, 1);
+        subscriber->elem = elem;
+        subscriber->view = view;
+        subscriber->refresh = refresh;
+
+        mixer_elem->subscribers = g_slist_append (mixer_elem->subscribers, subscriber);
+    }
+
+    g_rec_mutex_unlock (&gam_mixer->priv->lock);
+    if (gam_mixer_source_is_threaded ())
+        g_rec_mutex_unlock (&gam_mixer->priv->handle_lock);
+}
+
+void
+gam_mixer_unsubscribe (GamMixer         *gam_mixer,
+                       snd_mixer_elem_t *elem,
+                       GtkWidget        *view)
+{
+    GamMixerElem *mixer_elem;
+    GSList *l;
+
+    g_return_if_fail (GAM_IS_MIXER (gam_mixer));
+
+    g_rec_mutex_lock (&gam_mixer->priv->lock);
+
+    mixer_elem = g_hash_table_lookup (gam_mixer->priv->elems, elem);
+    for (l = mixer_elem ? mixer_elem->subscribers : NULL; l; l = l->next) {
+        GamMixerSubscriber * const subscriber = l->data;
+
+        if (subscriber->view == view) {
+            mixer_elem->subscribers = g_slist_delete_link (mixer_elem->subscribers, l);
+            g_free (subscriber);
+            break;
+        }
+    }
+
+    g_rec_mutex_unlock (&gam_mixer->priv->lock);
+}
+
+/* NULL for an element the mixer does not know, or no longer has */
+const GamElementInfo *
+gam_mixer_get_elem_info (GamMixer *gam_mixer, snd_mixer_elem_t *elem)
+{
+    g_return_val_if_fail (GAM_IS_MIXER (gam_mixer), NULL);
+
+    return gam_element_registry_lookup (gam_mixer->priv->registry, elem);
+}
+
+/* valid while a view is subscribed to the element; take a reference to keep it */
+GamElementModel *
+gam_mixer_get_model (GamMixer *gam_mixer, snd_mixer_elem_t *elem)
+{
+    GamMixerElem *mixer_elem;
+
+    g_return_val_if_fail (GAM_IS_MIXER (gam_mixer), NULL);
+
+    mixer_elem = g_hash_table_lookup (gam_mixer->priv->elems, elem);
+
+    return mixer_elem ? mixer_elem->model : NULL;
+}
+
+/* reads come from the element's cache, so this costs no ioctl */
+static void
+gam_mixer_elem_get_state (const GamElementInfo *info, GamEchoState *state)
+{
+    snd_mixer_selem_channel_id_t channel;
+
+    memset (state, 0, sizeof (*state));
+
+    for (channel = 0; channel < GAM_ECHO_FILTER_MAX_CHANNELS; channel++) {
+        if (info->channels[PLAYBACK] & (1u << channel)) {
+            if (info->has_volume[PLAYBACK])
+                snd_mixer_selem_get_playback_volume (info->elem, channel, &state->volume[0][channel]);
+            if (info->has_switch[PLAYBACK])
+                snd_mixer_selem_get_playback_switch (info->elem, channel, &state->switches[0][channel]);
+        }
+        if (info->channels[CAPTURE] & (1u << channel)) {
+            if (info->has_volume[CAPTURE])
+                snd_mixer_selem_get_capture_volume (info->elem, channel, &state->volume[1][channel]);
+            if (info->has_switch[CAPTURE])
+                snd_mixer_selem_get_capture_switch (info->elem, channel, &state->switches[1][channel]);
+        }
+    }
+}
+
+/*
+ * Views call this right after they wrote to an element.  ALSA reports our
+ * own writes back as value events; as long as the element still holds what
+ * we wrote, such an event is dropped before the model or any view sees it,
+ * so the model takes the written values from the snapshot here instead.
+ * The snapshot is compared where the events are handled, so it is taken
+ * with the handle locked, and found through the element itself rather than
+ * the table.
+ */
+void
+gam_mixer_note_write (GamMixer *gam_mixer, snd_mixer_elem_t *elem)
+{
+    GamMixerElem *mixer_elem;
+    GamEchoState state;
+
+    g_return_if_fail (GAM_IS_MIXER (gam_mixer));
+
+    g_rec_mutex_lock (&gam_mixer->priv->handle_lock);
+
+    /* the registry forgets an element as its removal is handled */
+    if (gam_element_registry_lookup (gam_mixer->priv->registry, elem) != NULL &&
+        snd_mixer_elem_get_callback_private (elem) != NULL) {
+        mixer_elem = snd_mixer_elem_get_callback_private (elem);
+        gam_mixer_elem_get_state (mixer_elem->info, &state);
+        gam_echo_filter_arm (&mixer_elem->echo, &state);
+        gam_element_model_seed (mixer_elem->model, state.volume, state.switches);
+    }
+
+    g_rec_mutex_unlock (&gam_mixer->priv->handle_lock);
+}
+
+/* a write of several channels, one by one, is echoed once per channel */
+static gboolean
+gam_mixer_elem_is_echo (GamMixerElem *mixer_elem, guint mask)
+{
+    GamEchoState state;
+
+    if (mask != SND_CTL_EVENT_MASK_VALUE || !mixer_elem->echo.armed)
+        return FALSE;
+
+    gam_mixer_elem_get_state (mixer_elem->info, &state);
+
+    return gam_echo_filter_check (&mixer_elem->echo, &state);
+}
+
+/* closes the rate window once it is a second old */
+static gdouble
+gam_mixer_elem_get_rate (GamMixerElem *mixer_elem, gint64 now)
+{
+    const gint64 elapsed = now - mixer_elem->window_start;
+
+    if (elapsed >= G_USEC_PER_SEC) {
+        mixer_elem->rate = (gdouble) mixer_elem->window_events * G_USEC_PER_SEC / elapsed;
+        mixer_elem->window_start = now;
+        mixer_elem->window_events = 0;
+    }
+
+    return mixer_elem->rate;
+}
+
+static void
+gam_mixer_elem_count_event (GamMixerElem *mixer_elem, gint64 now)
+{
+    gam_mixer_elem_get_rate (mixer_elem, now);
+
+    mixer_elem->events++;
+    mixer_elem->window_events++;
+}
+
+/*
+ * An element that floods us with events, such as a meter-like control, only
+ * updates its views a few times a second while the flood lasts.  Its views
+ * stay dirty meanwhile, so the last value is still shown.
+ */
+static gboolean
+gam_mixer_elem_is_throttled (GamMixerElem *mixer_elem, gint64 now)
+{
+    if (mixer_elem->last_update == now)
+        return FALSE;
+
+    if (gam_mixer_elem_get_rate (mixer_elem, now) <= GAM_MIXER_STORM_RATE &&
+        mixer_elem->window_events <= GAM_MIXER_STORM_RATE)
+        return FALSE;
+
+    return now - mixer_elem->last_update < G_USEC_PER_SEC / GAM_MIXER_STORM_UPDATES;
+}
+
+/* elements ALSA adds after the mixer was loaded, e.g. by a driver reload */
+static gint
+gam_mixer_event (snd_mixer_t *handle, guint mask, snd_mixer_elem_t *elem)
 {
-    const GamMixer * const gam_mixer = GAM_MIXER (data);
+    GamMixer * const gam_mixer = GAM_MIXER (snd_mixer_get_callback_private (handle));
 
-    snd_mixer_handle_events (gam_mixer->priv->handle);
+    if (mask & SND_CTL_EVENT_MASK_ADD)
+        gam_element_registry_add (gam_mixer->priv->registry, elem);
+
+    return 0;
+}
+
+/*
+ * Runs wherever the handle is polled, with the handle locked.  The model and
+ * the echo check only need the element, so they are done here; the views only
+ * hear of the event with the next frame.  On the event thread, the element and
+ * the event mask are queued for the main loop without taking the mixer lock.
+ * An element removed here is forgotten at once, so that no write touches it
+ * anymore.
+ */
+static gint
+gam_mixer_elem_event (snd_mixer_elem_t *elem, guint mask)
+{
+    GamMixerElem * const mixer_elem = snd_mixer_elem_get_callback_private (elem);
+    GamMixer * const gam_mixer = mixer_elem->mixer;
+
+    if (mask == SND_CTL_EVENT_MASK_REMOVE) {
+        g_atomic_int_set (&mixer_elem->removed, TRUE);
+        gam_element_registry_remove (gam_mixer->priv->registry, elem);
+        gam_element_model_detach (mixer_elem->model);
+    } else {
+        /* the raw values are enough to tell; the model has our writes already */
+        if (gam_mixer_elem_is_echo (mixer_elem, mask)) {
+            g_atomic_int_inc (&gam_mixer->priv->refresh_echoes);
+            return 0;
+        }
+
+        /* once for all views */
+        gam_element_model_update (mixer_elem->model, mask);
+    }
+
+    if (gam_mixer->priv->queue == NULL) {
+        gam_mixer_dispatch_event (gam_mixer, elem, mask);
+        return 0;
+    }
+
+    gam_event_queue_push (gam_mixer->priv->queue, elem, mask);
+
+    if (!g_atomic_int_get (&gam_mixer->priv->handoff_pending)) {
+        g_atomic_int_set (&gam_mixer->priv->handoff_pending, TRUE);
+        g_source_set_ready_time (gam_mixer->priv->handoff, 0);
+    }
+
+    return 0;
+}
+
+/* on the main thread; the model already has the event */
+static void
+gam_mixer_dispatch_event (GamMixer *gam_mixer, snd_mixer_elem_t *elem, guint mask)
+{
+    GamMixerElem *mixer_elem;
+    GSList *l;
+
+    g_rec_mutex_lock (&gam_mixer->priv->lock);
+
+    mixer_elem = g_hash_table_lookup (gam_mixer->priv->elems, elem);
+
+    /* whatever came before the removal no longer matters */
+    if (mixer_elem == NULL ||
+        (g_atomic_int_get (&mixer_elem->removed) && mask != SND_CTL_EVENT_MASK_REMOVE)) {
+        g_rec_mutex_unlock (&gam_mixer->priv->lock);
+        return;
+    }
+
+    if (mask == SND_CTL_EVENT_MASK_REMOVE) {
+        g_hash_table_remove (gam_mixer->priv->elems, elem);
+        g_hash_table_remove (gam_mixer->priv->dirty, mixer_elem);
+        g_hash_table_remove (gam_mixer->priv->draining, mixer_elem);
+
+        g_rec_mutex_unlock (&gam_mixer->priv->lock);
+
+        for (l = mixer_elem->subscribers; l; l = l->next) {
+            GamMixerSubscriber * const subscriber = l->data;
+
+            subscriber->refresh (subscriber->view, mask);
+        }
+
+        gam_mixer_elem_free (mixer_elem);
+        return;
+    }
+
+    gam_mixer_elem_count_event (mixer_elem, g_get_monotonic_time ());
+
+    /* the views hear of it with the next frame, of all events since the last one */
+    g_hash_table_add (gam_mixer->priv->dirty, mixer_elem);
+    gam_mixer->priv->refresh_events++;
+
+    g_rec_mutex_unlock (&gam_mixer->priv->lock);
+
+    gam_mixer_schedule_tick (gam_mixer);
+}
+
+static gboolean
+gam_mixer_handoff_dispatch (GSource *source, GSourceFunc callback, gpointer data)
+{
+    g_source_set_ready_time (source, -1);
+
+    return callback (data);
+}
+
+/* takes over the events the event thread queued since the last time */
+static gboolean
+gam_mixer_handoff (gpointer data)
+{
+    GamMixer * const gam_mixer = GAM_MIXER (data);
+    GamEvent event;
+    GList *elems, *l;
+
+    /* events queued from here on signal again */
+    g_atomic_int_set (&gam_mixer->priv->handoff_pending, FALSE);
+
+    /*
+     * Events were lost, but the models have them all, so every element only
+     * needs to tell its views; an element whose removal was lost goes now.
+     */
+    if (gam_event_queue_take_overflow (gam_mixer->priv->queue)) {
+        g_rec_mutex_lock (&gam_mixer->priv->lock);
+        elems = g_hash_table_get_keys (gam_mixer->priv->elems);
+        g_rec_mutex_unlock (&gam_mixer->priv->lock);
+
+        for (l = elems; l; l = l->next) {
+            GamMixerElem *mixer_elem;
+
+            g_rec_mutex_lock (&gam_mixer->priv->lock);
+            mixer_elem = g_hash_table_lookup (gam_mixer->priv->elems, l->data);
+            g_rec_mutex_unlock (&gam_mixer->priv->lock);
+
+            if (mixer_elem == NULL)
+                continue;
+
+            if (g_atomic_int_get (&mixer_elem->removed))
+                gam_mixer_dispatch_event (gam_mixer, l->data, SND_CTL_EVENT_MASK_REMOVE);
+            else
+                gam_mixer_dispatch_event (gam_mixer, l->data,
+                                          SND_CTL_EVENT_MASK_VALUE | SND_CTL_EVENT_MASK_INFO);
+        }
+        g_list_free (elems);
+    }
+
+    /* the only consumer; the queue needs no lock */
+    while (gam_event_queue_pop (gam_mixer->priv->queue, &event))
+        gam_mixer_dispatch_event (gam_mixer, event.elem, event.mask);
+
+    return G_SOURCE_CONTINUE;
+}
+
+void
+gam_mixer_get_refresh_stats (GamMixer *gam_mixer,
+                             guint64  *events,
+                             guint64  *updates,
+                             guint64  *frames,
+                             guint64  *echoes)
+{
+    g_return_if_fail (GAM_IS_MIXER (gam_mixer));
+
+    if (events)
+        *events = gam_mixer->priv->refresh_events;
+    if (updates)
+        *updates = gam_mixer->priv->refresh_updates;
+    if (frames)
+        *frames = gam_mixer->priv->refresh_frames;
+    if (echoes)
+        *echoes = (guint) g_atomic_int_get (&gam_mixer->priv->refresh_echoes);
+}
+
+static gboolean
+gam_mixer_tick (GtkWidget     *widget,
+                GdkFrameClock *frame_clock,
+                gpointer       data)
+{
+    GamMixer * const gam_mixer = GAM_MIXER (widget);
+    GHashTable *draining;
+    GHashTableIter iter;
+    GPtrArray *models;
+    gpointer key;
+    gint64 now;
+    guint i;
+
+    /* parked since this was scheduled; keep everything for when it is shown */
+    if (gam_mixer->priv->parked) {
+        gam_mixer->priv->tick_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    gam_mixer->priv->refresh_frames++;
+
+    /* the same for the whole frame; the event counts use the same clock */
+    now = gdk_frame_clock_get_frame_time (frame_clock);
+
+    models = g_ptr_array_new_with_free_func (g_object_unref);
+
+    g_rec_mutex_lock (&gam_mixer->priv->lock);
+
+    /* updating a widget may queue it again; that goes into the next frame */
+    draining = gam_mixer->priv->dirty;
+    gam_mixer->priv->dirty = gam_mixer->priv->draining;
+    gam_mixer->priv->draining = draining;
+
+    g_hash_table_iter_init (&iter, draining);
+    while (g_hash_table_iter_next (&iter, &key, NULL)) {
+        GamMixerElem * const mixer_elem = key;
+
+        /* its removal is on its way */
+        if (g_atomic_int_get (&mixer_elem->removed))
+            continue;
+
+        if (gam_mixer_elem_is_throttled (mixer_elem, now)) {
+            g_hash_table_add (gam_mixer->priv->dirty, mixer_elem);
+            mixer_elem->throttled++;
+            gam_mixer->priv->refresh_throttled++;
+            continue;
+        }
+
+        mixer_elem->last_update = now;
+        gam_mixer->priv->refresh_updates++;
+        g_ptr_array_add (models, g_object_ref (mixer_elem->model));
+    }
+    g_hash_table_remove_all (draining);
+
+    g_rec_mutex_unlock (&gam_mixer->priv->lock);
+
+    /* the views follow the model's signals, and may take the lock themselves */
+    for (i = 0; i < models->len; i++)
+        gam_element_model_flush (g_ptr_array_index (models, i));
+    g_ptr_array_free (models, TRUE);
+
+    if (g_hash_table_size (gam_mixer->priv->dirty) > 0)
+        return G_SOURCE_CONTINUE;
+
+    gam_mixer->priv->tick_id = 0;
+    return G_SOURCE_REMOVE;
+}
+
+static void
+gam_mixer_schedule_tick (GamMixer *gam_mixer)
+{
+    if (gam_mixer->priv->parked || gam_mixer->priv->tick_id != 0)
+        return;
+
+    gam_mixer->priv->tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (gam_mixer), gam_mixer_tick,
+                                                             NULL, NULL);
+}
+
+/*
+ * A mixer that is not on screen is parked: element events only record, per
+ * view, which parts changed, while the values themselves stay in ALSA's
+ * element cache.  Unparking brings all views up to date in one frame.
+ */
+void
+gam_mixer_set_parked (GamMixer *gam_mixer, gboolean parked)
+{
+    g_return_if_fail (GAM_IS_MIXER (gam_mixer));
+
+    if (gam_mixer->priv->parked == parked)
+        return;
+
+    gam_mixer->priv->parked = parked;
+
+    if (!parked && g_hash_table_size (gam_mixer->priv->dirty) > 0)
+        gam_mixer_schedule_tick (gam_mixer);
+}
+
+gboolean
+gam_mixer_get_parked (GamMixer *gam_mixer)
+{
+    g_return_val_if_fail (GAM_IS_MIXER (gam_mixer), FALSE);
+
+    return gam_mixer->priv->parked;
+}
+
+static gint
+gam_mixer_elem_stats_compare (gconstpointer a, gconstpointer b)
+{
+    const GamMixerElemStats * const stats_a = a;
+    const GamMixerElemStats * const stats_b = b;
+
+    if (stats_a->rate != stats_b->rate)
+        return stats_a->rate < stats_b->rate ? 1 : -1;
+
+    return stats_a->events < stats_b->events ? 1 : stats_a->events > stats_b->events ? -1 : 0;
+}
+
+/* per element event counts, the noisiest first; for debugging */
+GArray *
+gam_mixer_get_elem_stats (GamMixer *gam_mixer)
+{
+    const gint64 now = g_get_monotonic_time ();
+    GHashTableIter iter;
+    gpointer elem, mixer_elem;
+    GArray *stats;
+
+    g_return_val_if_fail (GAM_IS_MIXER (gam_mixer), NULL);
+
+    stats = g_array_new (FALSE, FALSE, sizeof (GamMixerElemStats));
+
+    g_rec_mutex_lock (&gam_mixer->priv->lock);
+
+    g_hash_table_iter_init (&iter, gam_mixer->priv->elems);
+    while (g_hash_table_iter_next (&iter, &elem, &mixer_elem)) {
+        GamMixerElem * const e = mixer_elem;
+        GamMixerElemStats elem_stats;
+
+        if (g_atomic_int_get (&e->removed))
+            continue;
+
+        elem_stats.name = g_quark_to_string (e->info->name);
+        elem_stats.events = e->events;
+        elem_stats.rate = gam_mixer_elem_get_rate (e, now);
+        elem_stats.throttled = e->throttled;
+        g_array_append_val (stats, elem_stats);
+    }
+
+    g_rec_mutex_unlock (&gam_mixer->priv->lock);
+
+    g_array_sort (stats, gam_mixer_elem_stats_compare);
+
+    return stats;
+}
+
+typedef struct
+{
+    GamMixer                *mixer;
+    snd_mixer_elem_t        *elem;
+    GtkWidget               *view;
+    GamMixerWriteFunc        write;
+    gpointer                 data;
+    GDestroyNotify           destroy;
+    GamMixerWriteFailedFunc  failed;
+    gint                     err;
+} GamMixerWrite;
+
+/* the view and the mixer go on the main thread, where they live */
+static gboolean
+gam_mixer_write_release (gpointer data)
+{
+    GamMixerWrite * const write = data;
+
+    g_object_unref (write->view);
+    g_object_unref (write->mixer);
+    g_free (write);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+gam_mixer_write_free (gpointer data)
+{
+    GamMixerWrite * const write = data;
+
+    if (write->destroy)
+        write->destroy (write->data);
+    g_idle_add (gam_mixer_write_release, write);
+}
+
+/* back on the main thread; the view may have been closed meanwhile */
+static gboolean
+gam_mixer_write_failed (gpointer data)
+{
+    GamMixerWrite * const write = data;
+
+    if (gtk_widget_is_ancestor (write->view, GTK_WIDGET (write->mixer)))
+        write->failed (write->view, write->err);
+
+    g_object_unref (write->view);
+    g_object_unref (write->mixer);
+    g_free (write);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * On the writer thread, with only the handle locked: the ioctl keeps the event
+ * thread out, but never the views, which read the models.
+ */
+static void
+gam_mixer_write_run (gpointer data)
+{
+    GamMixerWrite * const write = data;
+    GamMixerWrite *failure;
+    gint err;
+
+    if (!gam_mixer_lock_elem (write->mixer, write->elem))
+        return;
+
+    err = write->write (write->elem, write->data);
+    if (err >= 0)
+        gam_mixer_note_write (write->mixer, write->elem);
+
+    gam_mixer_unlock (write->mixer);
+
+    if (err >= 0 || write->failed == NULL)
+        return;
+
+    failure = g_new0 (GamMixerWrite, 1);
+    failure->mixer = g_object_ref (write->mixer);
+    failure->view = g_object_ref (write->view);
+    failure->failed = write->failed;
+    failure->err = err;
+    g_idle_add (gam_mixer_write_failed, failure);
+}
+
+typedef struct
+{
+    GamMixer        *mixer;
+    GamHistoryEntry *entry;
+    gboolean         ran;
+} GamMixerGesture;
+
+/* on the writer thread, with all writes posted before done */
+static void
+gam_mixer_read_raw (GamMixer *gam_mixer, GamHistoryEntry *entry, gboolean after)
+{
+    guint i;
+
+    if (!gam_mixer_lock_elem (gam_mixer, entry->elem))
+        return;
+
+    for (i = 0; i < entry->count; i++) {
+        GamHistoryValue * const value = &entry->values[i];
+        glong * const raw = after ? &value->new_value : &value->old_value;
+
+        if (entry->playback)
+            snd_mixer_selem_get_playback_volume (entry->elem, value->channel, raw);
+        else
+            snd_mixer_selem_get_capture_volume (entry->elem, value->channel, raw);
+    }
+
+    gam_mixer_unlock (gam_mixer);
+}
+
+static void
+gam_mixer_gesture_begin_run (gpointer data)
+{
+    GamMixerGesture * const gesture = data;
+
+    gam_mixer_read_raw (gesture->mixer, gesture->entry, FALSE);
+}
+
+static gboolean
+gam_mixer_gesture_push (gpointer data)
+{
+    GamMixerGesture * const gesture = data;
+
+    if (gesture->mixer->priv->history && gam_history_entry_is_change (gesture->entry))
+        gam_history_push (gesture->mixer->priv->history, gesture->entry);
+    else
+        g_free (gesture->entry);
+
+    g_object_unref (gesture->mixer);
+    g_free (gesture);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+gam_mixer_gesture_end_run (gpointer data)
+{
+    GamMixerGesture * const gesture = data;
+
+    gam_mixer_read_raw (gesture->mixer, gesture->entry, TRUE);
+
+    gesture->ran = TRUE;
+    g_idle_add (gam_mixer_gesture_push, gesture);
+}
+
+/* a gesture dropped before it could end is forgotten, on the main thread */
+static void
+gam_mixer_gesture_end_free (gpointer data)
+{
+    GamMixerGesture * const gesture = data;
+
+    if (gesture->ran)
+        return;
+
+    g_free (gesture->entry);
+    g_object_unref (gesture->mixer);
+    g_free (gesture);
+}
+
+/*
+ * A view starts a gesture before its first write and ends it after the
+ * last, e.g. when a drag ends; the history gets one entry for the whole of
+ * it.  The values are read by the writer thread, in order with the writes,
+ * so the main thread never waits for them.  NULL once the element is gone.
+ */
+gpointer
+gam_mixer_begin_gesture (GamMixer         *gam_mixer,
+                         snd_mixer_elem_t *elem,
+                         gboolean          playback)
+{
+    const GamElementInfo *info;
+    GamMixerGesture *gesture;
+
+    g_return_val_if_fail (GAM_IS_MIXER (gam_mixer), NULL);
+
+    info = gam_element_registry_lookup (gam_mixer->priv->registry, elem);
+    if (info == NULL)
+        return NULL;
+
+    /* no reference: this mail only runs on the writer, and gam_mixer_finalize()
+     * cancels the mixer's mails, waiting for one that runs, before it goes on;
+     * the end of the gesture takes one for the idle it adds
+     */
+    gesture = g_new (GamMixerGesture, 1);
+    gesture->mixer = gam_mixer;
+    gesture->entry = gam_history_entry_new (elem, playback, info->channels[playback ? PLAYBACK : CAPTURE]);
+    gesture->ran = FALSE;
+
+    /* the mixer owns these mails, they outlive a view that goes away */
+    gam_mixer_writer_post (gesture->entry, gam_mixer, gam_mixer_gesture_begin_run, gesture, g_free);
+
+    return gesture->entry;
+}
+
+void
+gam_mixer_end_gesture (GamMixer *gam_mixer, gpointer entry)
+{
+    GamMixerGesture *gesture;
+
+    g_return_if_fail (GAM_IS_MIXER (gam_mixer));
+
+    gesture = g_new (GamMixerGesture, 1);
+    gesture->mixer = g_object_ref (gam_mixer);
+    gesture->entry = entry;
+    gesture->ran = FALSE;
+
+    /* a slot of its own, the beginning may still wait in the entry's */
+    gam_mixer_writer_post (gesture, gam_mixer, gam_mixer_gesture_end_run,
+                           gesture, gam_mixer_gesture_end_free);
+}
+
+typedef struct
+{
+    GamMixer        *mixer;
+    gboolean         undo;
+    GamHistoryEntry  entry;
+} GamMixerReplay;
+
+/* on the writer thread; all channels of the entry in one go */
+static void
+gam_mixer_replay_run (gpointer data)
+{
+    GamMixerReplay * const replay = data;
+    GamHistoryEntry * const entry = &replay->entry;
+    gboolean same = TRUE;
+    glong raw;
+    guint i;
+
+    if (!gam_mixer_lock_elem (replay->mixer, entry->elem))
+        return;
+
+    for (i = 0; i < entry->count; i++) {
+        raw = replay->undo ? entry->values[i].old_value : entry->values[i].new_value;
+        same = same && raw == (replay->undo ? entry->values[0].old_value : entry->values[0].new_value);
+    }
+
+    for (i = 0; i < entry->count; i++) {
+        raw = replay->undo ? entry->values[i].old_value : entry->values[i].new_value;
+
+        if (same && entry->playback)
+            snd_mixer_selem_set_playback_volume_all (entry->elem, raw);
+        else if (same)
+            snd_mixer_selem_set_capture_volume_all (entry->elem, raw);
+        else if (entry->playback)
+            snd_mixer_selem_set_playback_volume (entry->elem, entry->values[i].channel, raw);
+        else
+            snd_mixer_selem_set_capture_volume (entry->elem, entry->values[i].channel, raw);
+
+        if (same)
+            break;
+    }
+
+    gam_mixer_unlock (replay->mixer);
+}
+
+/* the views see the values come back like any outside change */
+static void
+gam_mixer_replay (GamMixer *gam_mixer, const GamHistoryEntry *entry, gboolean undo)
+{
+    GamMixerReplay *replay;
+
+    replay = g_malloc (sizeof (GamMixerReplay) + entry->count * sizeof (GamHistoryValue));
+    replay->mixer = gam_mixer;
+    replay->undo = undo;
+    memcpy (&replay->entry, entry, sizeof (GamHistoryEntry) + entry->count * sizeof (GamHistoryValue));
+
+    /* every replay has a slot of its own, none may replace another */
+    gam_mixer_writer_post (replay, gam_mixer, gam_mixer_replay_run, replay, g_free);
+}
+
+gboolean
+gam_mixer_undo (GamMixer *gam_mixer)
+{
+    const GamHistoryEntry *entry;
+
+    g_return_val_if_fail (GAM_IS_MIXER (gam_mixer), FALSE);
+
+    entry = gam_history_undo (gam_mixer->priv->history);
+    if (entry == NULL)
+        return FALSE;
+
+    gam_mixer_replay (gam_mixer, entry, TRUE);
+
+    return TRUE;
+}
+
+gboolean
+gam_mixer_redo (GamMixer *gam_mixer)
+{
+    const GamHistoryEntry *entry;
+
+    g_return_val_if_fail (GAM_IS_MIXER (gam_mixer), FALSE);
+
+    entry = gam_history_redo (gam_mixer->priv->history);
+    if (entry == NULL)
+        return FALSE;
+
+    gam_mixer_replay (gam_mixer, entry, FALSE);
+
+    return TRUE;
+}
+
+/*
+ * The first simple element called 'name', or NULL.  Looked up in the
+ * registry, so that it never waits for the handle, which a write may hold.
+ */
+snd_mixer_elem_t *
+gam_mixer_find_elem (GamMixer *gam_mixer, const gchar *name)
+{
+    const GQuark quark = g_quark_try_string (name);
+    guint i, count;
+
+    g_return_val_if_fail (GAM_IS_MIXER (gam_mixer), NULL);
+
+    if (quark == 0)
+        return NULL;
+
+    count = gam_element_registry_get_count (gam_mixer->priv->registry);
+    for (i = 0; i < count; i++) {
+        const GamElementInfo * const info = gam_element_registry_get_nth (gam_mixer->priv->registry, i);
+
+        if (info->name == quark && info->index == 0 && info->elem != NULL)
+            return info->elem;
+    }
+
+    return NULL;
+}
+
+/*
+ * Views hand their writes to the writer thread and return at once.  'slot'
+ * holds one pending write; a newer one for the same slot replaces it.
+ * 'write' runs on the writer thread with the element locked, and when it fails,
+ * 'failed' is called on the main thread to show the real hardware value
+ * again.  Views cancel their writes with gam_mixer_cancel_writes() before
+ * they go away; every write holds the view and the mixer until it is done.
+ */
+void
+gam_mixer_post_write (GamMixer                *gam_mixer,
+                      snd_mixer_elem_t        *elem,
+                      GtkWidget               *view,
+                      gpointer                 slot,
+                      GamMixerWriteFunc        write_func,
+                      gpointer                 data,
+                      GDestroyNotify           destroy,
+                      GamMixerWriteFailedFunc  failed)
+{
+    GamMixerWrite *write;
+
+    g_return_if_fail (GAM_IS_MIXER (gam_mixer));
+    g_return_if_fail (write_func != NULL);
+
+    write = g_new (GamMixerWrite, 1);
+    write->mixer = g_object_ref (gam_mixer);
+    write->elem = elem;
+    write->view = g_object_ref (view);
+    write->write = write_func;
+    write->data = data;
+    write->destroy = destroy;
+    write->failed = failed;
+    write->err = 0;
+
+    gam_mixer_writer_post (slot, view, gam_mixer_write_run, write, gam_mixer_write_free);
+}
+
+/* a running write is not waited for, it holds on to what it needs */
+void
+gam_mixer_cancel_writes (GamMixer *gam_mixer, GtkWidget *view)
+{
+    g_return_if_fail (GAM_IS_MIXER (gam_mixer));
+
+    gam_mixer_writer_drop (view);
+}
+
+/*
+ * Writes hold the handle lock while they use an element, ioctl included; the
+ * views read the models instead, so neither waits for the other.  It is the
+ * lock the events are handled with, never the one of the element table; on
+ * the GTK thread the events wait for the write rather than the other way
+ * round.  gam_mixer_lock_elem() fails, without holding the lock, once the
+ * element is gone.
+ */
+void
+gam_mixer_lock (GamMixer *gam_mixer)
+{
+    g_return_if_fail (GAM_IS_MIXER (gam_mixer));
+
+    g_rec_mutex_lock (&gam_mixer->priv->handle_lock);
+}
+
+void
+gam_mixer_unlock (GamMixer *gam_mixer)
+{
+    g_return_if_fail (GAM_IS_MIXER (gam_mixer));
+
+    g_rec_mutex_unlock (&gam_mixer->priv->handle_lock);
+
+    if (g_atomic_int_compare_and_exchange (&gam_mixer->priv->refresh_deferred, TRUE, FALSE))
+        g_idle_add_full (G_PRIORITY_HIGH, gam_mixer_resume_events,
+                         g_object_ref (gam_mixer), g_object_unref);
+}
+
+gboolean
+gam_mixer_lock_elem (GamMixer *gam_mixer, snd_mixer_elem_t *elem)
+{
+    g_return_val_if_fail (GAM_IS_MIXER (gam_mixer), FALSE);
+
+    gam_mixer_lock (gam_mixer);
+
+    /* the registry forgets an element as its removal is handled, with the handle locked */
+    if (gam_element_registry_lookup (gam_mixer->priv->registry, elem) == NULL) {
+        gam_mixer_unlock (gam_mixer);
+        return FALSE;
+    }
 
     return TRUE;
 }
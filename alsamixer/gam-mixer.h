@@ -26,9 +26,12 @@
 #include <gtk/gtk.h>
 #include <gtk/gtksizegroup.h>
 #include <alsamixer/gam-app.h>
+#include <alsamixer/gam-card.h>
+#include <alsamixer/gam-element-registry.h>
 
 typedef struct _GamSlider GamSlider;
 typedef struct _GamToggle GamToggle;
+typedef struct _GamElementModel GamElementModel;
 
 G_BEGIN_DECLS
 
@@ -56,12 +59,34 @@ struct _GamMixerClass
 
     void (* display_name_changed) (GtkWidget *w);
     void (* visibility_changed)   (GtkWidget *w);
+    void (* disconnected)         (GtkWidget *w);
 };
 
+/* called with SND_CTL_EVENT_MASK_REMOVE when the element goes away */
+typedef void (* GamMixerRefreshFunc) (GtkWidget *view,
+                                      guint      mask);
+
+/* runs on the writer thread; returns 0 or a negative error code */
+typedef gint (* GamMixerWriteFunc)       (snd_mixer_elem_t *elem,
+                                          gpointer          data);
+typedef void (* GamMixerWriteFailedFunc) (GtkWidget        *view,
+                                          gint              err);
+
+typedef struct
+{
+    const gchar *name;
+    guint64      events;
+    gdouble      rate;        /* events per second */
+    guint64      throttled;   /* view updates held back */
+} GamMixerElemStats;
+
 GType                 gam_mixer_get_type          (void) G_GNUC_CONST;
 GtkWidget            *gam_mixer_new               (GamApp      *gam_app,
                                                    const gchar *card_id,
                                                    const gchar *style);
+GtkWidget            *gam_mixer_new_for_card      (GamApp      *gam_app,
+                                                   GamCard     *card,
+                                                   const gchar *style);
 const gchar          *gam_mixer_get_mixer_name    (GamMixer    *gam_mixer);
 const gchar          *gam_mixer_get_config_name   (GamMixer    *gam_mixer);
 gchar                *gam_mixer_get_display_name  (GamMixer    *gam_mixer);
@@ -70,7 +95,52 @@ void                  gam_mixer_set_display_name  (GamMixer    *gam_mixer,
 gboolean              gam_mixer_get_visible       (GamMixer    *gam_mixer);
 void                  gam_mixer_set_visible       (GamMixer    *gam_mixer,
                                                    gboolean     visible);
+GArray               *gam_mixer_get_elem_stats    (GamMixer    *gam_mixer);
+snd_mixer_elem_t     *gam_mixer_find_elem         (GamMixer    *gam_mixer,
+                                                   const gchar *name);
+gpointer              gam_mixer_begin_gesture     (GamMixer    *gam_mixer,
+                                                   snd_mixer_elem_t *elem,
+                                                   gboolean     playback);
+void                  gam_mixer_end_gesture       (GamMixer    *gam_mixer,
+                                                   gpointer     gesture);
+gboolean              gam_mixer_undo              (GamMixer    *gam_mixer);
+gboolean              gam_mixer_redo              (GamMixer    *gam_mixer);
+void                  gam_mixer_post_write        (GamMixer    *gam_mixer,
+                                                   snd_mixer_elem_t *elem,
+                                                   GtkWidget   *view,
+                                                   gpointer     slot,
+                                                   GamMixerWriteFunc write_func,
+                                                   gpointer     data,
+                                                   GDestroyNotify destroy,
+                                                   GamMixerWriteFailedFunc failed);
+void                  gam_mixer_cancel_writes     (GamMixer    *gam_mixer,
+                                                   GtkWidget   *view);
+void                  gam_mixer_set_parked        (GamMixer    *gam_mixer,
+                                                   gboolean     parked);
+gboolean              gam_mixer_get_parked        (GamMixer    *gam_mixer);
 void                  gam_mixer_show_props_dialog (GamMixer    *gam_mixer);
+void                  gam_mixer_subscribe         (GamMixer    *gam_mixer,
+                                                   snd_mixer_elem_t *elem,
+                                                   GtkWidget   *view,
+                                                   GamMixerRefreshFunc refresh);
+void                  gam_mixer_unsubscribe       (GamMixer    *gam_mixer,
+                                                   snd_mixer_elem_t *elem,
+                                                   GtkWidget   *view);
+GamElementModel      *gam_mixer_get_model         (GamMixer    *gam_mixer,
+                                                   snd_mixer_elem_t *elem);
+const GamElementInfo *gam_mixer_get_elem_info     (GamMixer    *gam_mixer,
+                                                   snd_mixer_elem_t *elem);
+void                  gam_mixer_note_write        (GamMixer    *gam_mixer,
+                                                   snd_mixer_elem_t *elem);
+void                  gam_mixer_get_refresh_stats (GamMixer    *gam_mixer,
+                                                   guint64     *events,
+                                                   guint64     *updates,
+                                                   guint64     *frames,
+                                                   guint64     *echoes);
+void                  gam_mixer_lock              (GamMixer    *gam_mixer);
+void                  gam_mixer_unlock            (GamMixer    *gam_mixer);
+gboolean              gam_mixer_lock_elem         (GamMixer    *gam_mixer,
+                                                   snd_mixer_elem_t *elem);
 
 
 G_END_DECLS
@@ -28,9 +28,7 @@
 #include <glib/gi18n.h>
 
 #include "gam-slider-dual.h"
-
-/* TODO: move to enum file and rewrite the property */
-enum ctl_dir { PLAYBACK, CAPTURE };
+#include "gam-element-model.h"
 
 struct _GamSliderDualPrivate
 {
@@ -40,45 +38,32 @@ struct _GamSliderDualPrivate
     GtkAdjustment *vol_adjustment_left;
     GtkAdjustment *vol_adjustment_right;
     gdouble    pan;
+    gdouble    volume_left;
+    gdouble    volume_right;
     gboolean   refreshing;
+    gboolean   write_left;
+    gboolean   write_right;
     enum ctl_dir   type;
 };
 
-static int (* const is_mono[2])(snd_mixer_elem_t *) = {
-    snd_mixer_selem_is_playback_mono,
-    snd_mixer_selem_is_capture_mono,
-};
-
-static int (* const has_volume[2])(snd_mixer_elem_t *) = {
-    snd_mixer_selem_has_playback_volume,
-    snd_mixer_selem_has_capture_volume,
-};
-
-static double (* const get_normalized_volume[2])(snd_mixer_elem_t *, snd_mixer_selem_channel_id_t) = {
-    get_normalized_playback_volume,
-    get_normalized_capture_volume,
-};
-
-static int (* const set_normalized_volume[2])(snd_mixer_elem_t *, snd_mixer_selem_channel_id_t, double, int) = {
-    set_normalized_playback_volume,
-    set_normalized_capture_volume,
-};
+static const snd_mixer_selem_channel_id_t front_left = SND_MIXER_SCHN_FRONT_LEFT;
+static const snd_mixer_selem_channel_id_t front_right = SND_MIXER_SCHN_FRONT_RIGHT;
 
 static void     gam_slider_dual_finalize                      (GObject               *object);
 static GObject *gam_slider_dual_constructor                   (GType                  type,
                                                                guint                  n_construct_properties,
                                                                GObjectConstructParam *construct_params);
-static gint     gam_slider_dual_get_volume_left               (GamSliderDual         *gam_slider_dual);
-static gint     gam_slider_dual_get_volume_right              (GamSliderDual         *gam_slider_dual);
-static void     gam_slider_dual_update_volume_left            (GamSliderDual         *gam_slider_dual);
-static void     gam_slider_dual_update_volume_right           (GamSliderDual         *gam_slider_dual);
+static gdouble  gam_slider_dual_get_volume_left               (GamSliderDual         *gam_slider_dual);
+static gdouble  gam_slider_dual_get_volume_right              (GamSliderDual         *gam_slider_dual);
 static gint     gam_slider_dual_lock_button_toggled_cb        (GtkWidget             *widget,
                                                                GamSliderDual         *gam_slider_dual);
 static gint     gam_slider_dual_volume_left_value_changed_cb  (GtkWidget             *widget,
                                                                GamSliderDual         *gam_slider_dual);
 static gint     gam_slider_dual_volume_right_value_changed_cb (GtkWidget             *widget,
                                                                GamSliderDual         *gam_slider_dual);
-static void     gam_slider_dual_refresh                       (GamSlider             *gam_slider);
+static void     gam_slider_dual_refresh                       (GamSlider             *gam_slider,
+                                                               guint                  channels);
+static void     gam_slider_dual_write                         (GamSlider             *gam_slider);
 static void     gam_slider_dual_set_pan                       (GamSliderDual         *gam_slider_dual);
 static gboolean gam_slider_dual_get_locked                    (GamSliderDual         *gam_slider_dual);
 static void     gam_slider_dual_set_locked                    (GamSliderDual         *gam_slider_dual,
@@ -101,6 +86,7 @@ gam_slider_dual_class_init (GamSliderDualClass *klass)
     gobject_class->constructor = gam_slider_dual_constructor;
 
     object_class->refresh = gam_slider_dual_refresh;
+    object_class->write = gam_slider_dual_write;
 }
 
 static void
@@ -115,7 +101,11 @@ gam_slider_dual_init (GamSliderDual *gam_slider_dual)
     gam_slider_dual->priv->vol_slider_right = NULL;
     gam_slider_dual->priv->vol_adjustment_left = NULL;
     gam_slider_dual->priv->vol_adjustment_right = NULL;
+    gam_slider_dual->priv->volume_left = 0;
+    gam_slider_dual->priv->volume_right = 0;
     gam_slider_dual->priv->refreshing = FALSE;
+    gam_slider_dual->priv->write_left = FALSE;
+    gam_slider_dual->priv->write_right = FALSE;
 }
 
 static void
@@ -160,7 +150,9 @@ gam_slider_dual_constructor (GType                  type,
     hbox = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
     gtk_widget_show (hbox);
 
-    gam_slider_dual->priv->vol_adjustment_left = gtk_adjustment_new (gam_slider_dual_get_volume_left (gam_slider_dual), 0, 100, 1, 5, 1);
+    gam_slider_dual->priv->volume_left = gam_slider_dual_get_volume_left (gam_slider_dual);
+    gam_slider_dual->priv->vol_adjustment_left = gam_slider_new_volume_adjustment (GAM_SLIDER (gam_slider_dual),
+                                                                                   gam_slider_dual->priv->volume_left);
 
     g_signal_connect (G_OBJECT (gam_slider_dual->priv->vol_adjustment_left), "value-changed", G_CALLBACK (gam_slider_dual_volume_left_value_changed_cb), gam_slider_dual);
 
@@ -168,11 +160,15 @@ gam_slider_dual_constructor (GType                  type,
     gtk_range_set_inverted (GTK_RANGE (gam_slider_dual->priv->vol_slider_left), TRUE);
     gtk_widget_show (gam_slider_dual->priv->vol_slider_left);
     gtk_scale_set_draw_value (GTK_SCALE (gam_slider_dual->priv->vol_slider_left), FALSE);
+    gam_slider_watch_drag (GAM_SLIDER (gam_slider_dual), gam_slider_dual->priv->vol_slider_left);
+    gam_slider_watch_steps (GAM_SLIDER (gam_slider_dual), gam_slider_dual->priv->vol_slider_left);
 
     gtk_box_pack_start (GTK_BOX (hbox), gam_slider_dual->priv->vol_slider_left, TRUE, TRUE, 0);
 
-    if (!is_mono[gam_slider_dual->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_dual)))) {
-        gam_slider_dual->priv->vol_adjustment_right = gtk_adjustment_new (gam_slider_dual_get_volume_right (gam_slider_dual), 0, 100, 1, 5, 1);
+    if (!gam_slider_get_info (GAM_SLIDER (gam_slider_dual))->is_mono[gam_slider_dual->priv->type]) {
+        gam_slider_dual->priv->volume_right = gam_slider_dual_get_volume_right (gam_slider_dual);
+        gam_slider_dual->priv->vol_adjustment_right = gam_slider_new_volume_adjustment (GAM_SLIDER (gam_slider_dual),
+                                                                                        gam_slider_dual->priv->volume_right);
 
         g_signal_connect (G_OBJECT (gam_slider_dual->priv->vol_adjustment_right), "value-changed", G_CALLBACK (gam_slider_dual_volume_right_value_changed_cb), gam_slider_dual);
 
@@ -180,13 +176,15 @@ gam_slider_dual_constructor (GType                  type,
         gtk_range_set_inverted (GTK_RANGE (gam_slider_dual->priv->vol_slider_right), TRUE);
         gtk_widget_show (gam_slider_dual->priv->vol_slider_right);
         gtk_scale_set_draw_value (GTK_SCALE (gam_slider_dual->priv->vol_slider_right), FALSE);
+        gam_slider_watch_drag (GAM_SLIDER (gam_slider_dual), gam_slider_dual->priv->vol_slider_right);
+        gam_slider_watch_steps (GAM_SLIDER (gam_slider_dual), gam_slider_dual->priv->vol_slider_right);
 
         gtk_box_pack_start (GTK_BOX (hbox), gam_slider_dual->priv->vol_slider_right, TRUE, TRUE, 0);
     }
 
     gam_slider_add_volume_widget (GAM_SLIDER (gam_slider_dual), hbox);
 
-    if (!is_mono[gam_slider_dual->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_dual)))) {
+    if (!gam_slider_get_info (GAM_SLIDER (gam_slider_dual))->is_mono[gam_slider_dual->priv->type]) {
         if (gam_app_get_slider_toggle_style () == 0)
             gam_slider_dual->priv->lock_button = gtk_toggle_button_new_with_label (_("Lock"));
         else
@@ -210,54 +208,39 @@ gam_slider_dual_constructor (GType                  type,
     return object;
 }
 
-static gint
+static gdouble
 gam_slider_dual_get_volume_left (GamSliderDual *gam_slider_dual)
 {
     gdouble vol;
 
-    vol = get_normalized_volume[gam_slider_dual->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_dual)), SND_MIXER_SCHN_FRONT_LEFT);
+    vol = gam_element_model_get_normalized (gam_slider_get_model (GAM_SLIDER (gam_slider_dual)),
+                                            gam_slider_dual->priv->type, SND_MIXER_SCHN_FRONT_LEFT);
 
-    return lrint (ceil (vol * 100));
+    return vol * 100;
 }
 
-static gint
+static gdouble
 gam_slider_dual_get_volume_right (GamSliderDual *gam_slider_dual)
 {
     gdouble vol;
 
-    vol = get_normalized_volume[gam_slider_dual->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_dual)), SND_MIXER_SCHN_FRONT_RIGHT);
+    vol = gam_element_model_get_normalized (gam_slider_get_model (GAM_SLIDER (gam_slider_dual)),
+                                            gam_slider_dual->priv->type, SND_MIXER_SCHN_FRONT_RIGHT);
 
-    return lrint (ceil (vol * 100));
+    return vol * 100;
 }
 
 static void
-gam_slider_dual_update_volume_left (GamSliderDual *gam_slider_dual)
+gam_slider_dual_show_volume (GamSliderDual *gam_slider_dual, GtkAdjustment *adjustment, gdouble value)
 {
-    gdouble vol_value;
+    const gboolean refreshing = gam_slider_dual->priv->refreshing;
 
-    /* get values */
-    if (gam_slider_dual->priv->vol_adjustment_left)
-        vol_value = gtk_adjustment_get_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_left)) / 100;
-    else
-        vol_value = 0;
+    if (adjustment == NULL)
+        return;
 
-    /* set volume */
-    set_normalized_volume[gam_slider_dual->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_dual)), SND_MIXER_SCHN_FRONT_LEFT, vol_value, 1);
-}
-
-static void
-gam_slider_dual_update_volume_right (GamSliderDual *gam_slider_dual)
-{
-    gdouble vol_value;
-
-    /* get values */
-    if (gam_slider_dual->priv->vol_adjustment_left)
-        vol_value = gtk_adjustment_get_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_right)) / 100;
-    else
-        vol_value = 0;
-
-    /* set volume */
-    set_normalized_volume[gam_slider_dual->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_dual)), SND_MIXER_SCHN_FRONT_RIGHT, vol_value, 1);
+    gam_slider_dual->priv->refreshing = TRUE;
+    gtk_adjustment_set_value (adjustment, value);
+    gam_slider_dual->priv->refreshing = refreshing;
 }
 
 static gint
@@ -272,25 +255,26 @@ gam_slider_dual_lock_button_toggled_cb (GtkWidget *widget, GamSliderDual *gam_sl
     return TRUE;
 }
 
+/* the locked slider follows at once; both are written with the next frame */
 static gint
 gam_slider_dual_volume_left_value_changed_cb (GtkWidget *widget, GamSliderDual *gam_slider_dual)
 {
     if (gam_slider_dual->priv->refreshing)
         return TRUE;
 
-    gam_slider_dual_update_volume_left (gam_slider_dual);
+    gam_slider_dual->priv->write_left = TRUE;
 
-    if (!is_mono[gam_slider_dual->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_dual)))) {
+    if (!gam_slider_get_info (GAM_SLIDER (gam_slider_dual))->is_mono[gam_slider_dual->priv->type]) {
         if (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (gam_slider_dual->priv->lock_button))) {
-            gtk_adjustment_set_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_right),
-                                      gtk_adjustment_get_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_left)) -
-                                      gam_slider_dual->priv->pan);
-
-            gam_slider_dual_update_volume_right (gam_slider_dual);
-            gam_slider_dual_set_pan (gam_slider_dual);
+            gam_slider_dual_show_volume (gam_slider_dual, gam_slider_dual->priv->vol_adjustment_right,
+                                         gtk_adjustment_get_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_left)) -
+                                         gam_slider_dual->priv->pan);
+            gam_slider_dual->priv->write_right = TRUE;
         }
     }
 
+    gam_slider_queue_write (GAM_SLIDER (gam_slider_dual));
+
     return TRUE;
 }
 
@@ -300,40 +284,93 @@ gam_slider_dual_volume_right_value_changed_cb (GtkWidget *widget, GamSliderDual
     if (gam_slider_dual->priv->refreshing)
         return TRUE;
 
-    gam_slider_dual_update_volume_right (gam_slider_dual);
+    gam_slider_dual->priv->write_right = TRUE;
 
-    if (!is_mono[gam_slider_dual->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_dual)))) {
+    if (!gam_slider_get_info (GAM_SLIDER (gam_slider_dual))->is_mono[gam_slider_dual->priv->type]) {
         if (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (gam_slider_dual->priv->lock_button))) {
-            gtk_adjustment_set_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_left),
-                                      gtk_adjustment_get_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_right)) +
-                                      gam_slider_dual->priv->pan);
-
-            gam_slider_dual_update_volume_left (gam_slider_dual);
-            gam_slider_dual_set_pan (gam_slider_dual);
+            gam_slider_dual_show_volume (gam_slider_dual, gam_slider_dual->priv->vol_adjustment_left,
+                                         gtk_adjustment_get_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_right)) +
+                                         gam_slider_dual->priv->pan);
+            gam_slider_dual->priv->write_left = TRUE;
         }
     }
 
+    gam_slider_queue_write (GAM_SLIDER (gam_slider_dual));
+
     return TRUE;
 }
 
+/*
+ * Locked sliders move together, so both channels go in one write, which is a
+ * single call when they are equal; the pan stays what it was and the sliders
+ * only show the steps it rounds to.
+ */
+static void
+gam_slider_dual_write (GamSlider *gam_slider)
+{
+    GamSliderDual * const gam_slider_dual = GAM_SLIDER_DUAL (gam_slider);
+    GtkAdjustment *adjustments[2];
+    snd_mixer_selem_channel_id_t channels[2];
+    gdouble volumes[2], *shown[2];
+    guint count = 0, i;
+    gint dir = 0;
+
+    if (gam_slider_dual->priv->write_left && gam_slider_dual->priv->vol_adjustment_left) {
+        adjustments[count] = gam_slider_dual->priv->vol_adjustment_left;
+        channels[count] = front_left;
+        shown[count] = &gam_slider_dual->priv->volume_left;
+        count++;
+    }
+    if (gam_slider_dual->priv->write_right && gam_slider_dual->priv->vol_adjustment_right) {
+        adjustments[count] = gam_slider_dual->priv->vol_adjustment_right;
+        channels[count] = front_right;
+        shown[count] = &gam_slider_dual->priv->volume_right;
+        count++;
+    }
+
+    gam_slider_dual->priv->write_left = FALSE;
+    gam_slider_dual->priv->write_right = FALSE;
+
+    if (count == 0)
+        return;
+
+    for (i = 0; i < count; i++) {
+        volumes[i] = gtk_adjustment_get_value (adjustments[i]) / 100;
+
+        /* round towards the direction of the movement, so every move reaches the next hardware step */
+        if (dir == 0 && volumes[i] * 100 != *shown[i])
+            dir = volumes[i] * 100 < *shown[i] ? -1 : 1;
+    }
+    if (dir == 0)
+        dir = 1;
+
+    gam_slider_post_volume (GAM_SLIDER (gam_slider_dual), adjustments[0], channels, volumes, count, dir);
+
+    /* show the hardware steps that were written */
+    for (i = 0; i < count; i++) {
+        *shown[i] = gam_element_model_quantize (gam_slider_get_model (GAM_SLIDER (gam_slider_dual)),
+                                                gam_slider_dual->priv->type,
+                                                volumes[i], dir) * 100;
+        gam_slider_dual_show_volume (gam_slider_dual, adjustments[i], *shown[i]);
+    }
+}
+
 static void
-gam_slider_dual_refresh (GamSlider *gam_slider)
+gam_slider_dual_refresh (GamSlider *gam_slider, guint channels)
 {
-    GamSliderDual * const gam_slider_dual = GAM_SLIDER_DUAL (snd_mixer_elem_get_callback_private (gam_slider_get_elem (gam_slider)));
+    GamSliderDual * const gam_slider_dual = GAM_SLIDER_DUAL (gam_slider);
 
     gam_slider_dual->priv->refreshing = TRUE;
 
-    /* disconnect the signal, otherwise a value change outside the app causes a refresh, which sets the value, which calls the callback,
-     * which in turn rounds the value and sets it again system-wide
+    /* the adjustments hold the exact positions of the hardware steps, so showing an outside change
+     * must not write it back; the refreshing flag keeps the value-changed callbacks quiet meanwhile
      */
-    g_signal_handlers_disconnect_by_data (G_OBJECT (gam_slider_dual->priv->vol_adjustment_left), gam_slider_dual);
-    gtk_adjustment_set_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_left), (gdouble) gam_slider_dual_get_volume_left (gam_slider_dual));
-    g_signal_connect (G_OBJECT (gam_slider_dual->priv->vol_adjustment_left), "value-changed", G_CALLBACK (gam_slider_dual_volume_left_value_changed_cb), gam_slider_dual);
+    gam_slider_dual->priv->volume_left = gam_slider_dual_get_volume_left (gam_slider_dual);
+    gtk_adjustment_set_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_left), gam_slider_dual->priv->volume_left);
 
-    if (!is_mono[gam_slider_dual->priv->type] (gam_slider_get_elem (gam_slider))) {
-        g_signal_handlers_disconnect_by_data (G_OBJECT (gam_slider_dual->priv->vol_adjustment_right), gam_slider_dual);
-        gtk_adjustment_set_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_right), (gdouble) gam_slider_dual_get_volume_right (gam_slider_dual));
-        g_signal_connect (G_OBJECT (gam_slider_dual->priv->vol_adjustment_right), "value-changed", G_CALLBACK (gam_slider_dual_volume_right_value_changed_cb), gam_slider_dual);
+    if (!gam_slider_get_info (gam_slider)->is_mono[gam_slider_dual->priv->type]) {
+        gam_slider_dual->priv->volume_right = gam_slider_dual_get_volume_right (gam_slider_dual);
+        gtk_adjustment_set_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_right), gam_slider_dual->priv->volume_right);
     }
 
     gam_slider_dual_set_pan (gam_slider_dual);
@@ -341,14 +378,15 @@ gam_slider_dual_refresh (GamSlider *gam_slider)
     gam_slider_dual->priv->refreshing = FALSE;
 }
 
+/* from the exact volumes in the model, not from the rounded sliders, so it does not drift */
 static void
 gam_slider_dual_set_pan (GamSliderDual *gam_slider_dual)
 {
     g_return_if_fail (GAM_IS_SLIDER_DUAL (gam_slider_dual));
 
     if (gam_slider_dual->priv->vol_adjustment_right != NULL)
-        gam_slider_dual->priv->pan = gtk_adjustment_get_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_left)) -
-                                     gtk_adjustment_get_value (GTK_ADJUSTMENT (gam_slider_dual->priv->vol_adjustment_right));
+        gam_slider_dual->priv->pan = gam_slider_dual_get_volume_left (gam_slider_dual) -
+                                     gam_slider_dual_get_volume_right (gam_slider_dual);
 }
 
 static gboolean
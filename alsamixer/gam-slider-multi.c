@@ -0,0 +1,339 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+/*
+ * A strip with one slider for every channel of a surround element.  The
+ * channels are always written together, in one pass over the element, so
+ * equal channels become a single *_all write in the volume mapping.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <alsamixer/volume_mapping.h>
+#include <glib/gi18n.h>
+
+#include "gam-slider-multi.h"
+#include "gam-element-model.h"
+
+struct _GamSliderMultiPrivate
+{
+    GtkWidget     *lock_button;
+    GtkWidget     *vol_sliders[VOLUME_MAPPING_MAX_CHANNELS];
+    GtkAdjustment *vol_adjustments[VOLUME_MAPPING_MAX_CHANNELS];
+    snd_mixer_selem_channel_id_t channels[VOLUME_MAPPING_MAX_CHANNELS];
+    guint          n_channels;
+    /* the hardware step each slider was last set to, 0 - 100 */
+    gdouble        volumes[VOLUME_MAPPING_MAX_CHANNELS];
+    gboolean       refreshing;
+    gboolean       write_pending;
+    gint           dir;
+    enum ctl_dir   type;
+};
+
+/* short names, the strips have little room */
+static const gchar * const channel_names[] = {
+    [SND_MIXER_SCHN_FRONT_LEFT]   = N_("FL"),
+    [SND_MIXER_SCHN_FRONT_RIGHT]  = N_("FR"),
+    [SND_MIXER_SCHN_REAR_LEFT]    = N_("RL"),
+    [SND_MIXER_SCHN_REAR_RIGHT]   = N_("RR"),
+    [SND_MIXER_SCHN_FRONT_CENTER] = N_("FC"),
+    [SND_MIXER_SCHN_WOOFER]       = N_("LFE"),
+    [SND_MIXER_SCHN_SIDE_LEFT]    = N_("SL"),
+    [SND_MIXER_SCHN_SIDE_RIGHT]   = N_("SR"),
+    [SND_MIXER_SCHN_REAR_CENTER]  = N_("RC"),
+};
+
+static void     gam_slider_multi_finalize                (GObject               *object);
+static GObject *gam_slider_multi_constructor             (GType                  type,
+                                                          guint                  n_construct_properties,
+                                                          GObjectConstructParam *construct_params);
+static void     gam_slider_multi_read_volumes            (GamSliderMulti        *gam_slider_multi);
+static gint     gam_slider_multi_volume_value_changed_cb (GtkAdjustment         *adjustment,
+                                                          GamSliderMulti        *gam_slider_multi);
+static void     gam_slider_multi_refresh                 (GamSlider             *gam_slider,
+                                                          guint                  channels);
+static void     gam_slider_multi_write                   (GamSlider             *gam_slider);
+
+static gpointer parent_class;
+
+G_DEFINE_TYPE_WITH_CODE (GamSliderMulti , gam_slider_multi, GAM_TYPE_SLIDER,
+                         G_ADD_PRIVATE (GamSliderMulti))
+
+static void
+gam_slider_multi_class_init (GamSliderMultiClass *klass)
+{
+    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+    GamSliderClass *object_class = GAM_SLIDER_CLASS (klass);
+
+    parent_class = g_type_class_peek_parent (klass);
+
+    gobject_class->finalize = gam_slider_multi_finalize;
+    gobject_class->constructor = gam_slider_multi_constructor;
+
+    object_class->refresh = gam_slider_multi_refresh;
+    object_class->write = gam_slider_multi_write;
+}
+
+static void
+gam_slider_multi_init (GamSliderMulti *gam_slider_multi)
+{
+    g_return_if_fail (GAM_IS_SLIDER_MULTI (gam_slider_multi));
+
+    gam_slider_multi->priv = gam_slider_multi_get_instance_private (gam_slider_multi);
+
+    gam_slider_multi->priv->lock_button = NULL;
+    gam_slider_multi->priv->n_channels = 0;
+    gam_slider_multi->priv->refreshing = FALSE;
+    gam_slider_multi->priv->write_pending = FALSE;
+    gam_slider_multi->priv->dir = 1;
+}
+
+static void
+gam_slider_multi_finalize (GObject *object)
+{
+    GamSliderMulti *gam_slider_multi;
+
+    g_return_if_fail (GAM_IS_SLIDER_MULTI (object));
+
+    gam_slider_multi = GAM_SLIDER_MULTI (object);
+
+    gam_slider_multi->priv->n_channels = 0;
+
+    G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static GObject *
+gam_slider_multi_constructor (GType                  type,
+                              guint                  n_construct_properties,
+                              GObjectConstructParam *construct_params)
+{
+    GObject        *object;
+    GamSliderMulti *gam_slider_multi;
+    GtkWidget      *hbox, *vbox, *label;
+    gboolean        is_playback;
+    guint           i;
+
+    object = (* G_OBJECT_CLASS (parent_class)->constructor) (type,
+                                                             n_construct_properties,
+                                                             construct_params);
+
+    gam_slider_multi = GAM_SLIDER_MULTI (object);
+
+    g_object_get (G_OBJECT (gam_slider_multi), "is-playback", &is_playback, NULL);
+    if (is_playback == TRUE)
+        gam_slider_multi->priv->type = PLAYBACK;
+    else
+        gam_slider_multi->priv->type = CAPTURE;
+
+    gam_slider_multi->priv->n_channels = gam_element_model_get_channels (gam_slider_get_model (GAM_SLIDER (gam_slider_multi)),
+                                                                         gam_slider_multi->priv->type,
+                                                                         gam_slider_multi->priv->channels);
+    gam_slider_multi_read_volumes (gam_slider_multi);
+
+    hbox = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+    gtk_widget_show (hbox);
+
+    for (i = 0; i < gam_slider_multi->priv->n_channels; i++) {
+        const snd_mixer_selem_channel_id_t channel = gam_slider_multi->priv->channels[i];
+
+        vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+        gtk_widget_show (vbox);
+
+        gam_slider_multi->priv->vol_adjustments[i] = gam_slider_new_volume_adjustment (GAM_SLIDER (gam_slider_multi),
+                                                                                       gam_slider_multi->priv->volumes[i]);
+
+        g_signal_connect (G_OBJECT (gam_slider_multi->priv->vol_adjustments[i]), "value-changed",
+                          G_CALLBACK (gam_slider_multi_volume_value_changed_cb), gam_slider_multi);
+
+        gam_slider_multi->priv->vol_sliders[i] = gtk_scale_new (GTK_ORIENTATION_VERTICAL,
+                                                                GTK_ADJUSTMENT (gam_slider_multi->priv->vol_adjustments[i]));
+        gtk_range_set_inverted (GTK_RANGE (gam_slider_multi->priv->vol_sliders[i]), TRUE);
+        gtk_widget_show (gam_slider_multi->priv->vol_sliders[i]);
+        gtk_scale_set_draw_value (GTK_SCALE (gam_slider_multi->priv->vol_sliders[i]), FALSE);
+        gam_slider_watch_drag (GAM_SLIDER (gam_slider_multi), gam_slider_multi->priv->vol_sliders[i]);
+        gam_slider_watch_steps (GAM_SLIDER (gam_slider_multi), gam_slider_multi->priv->vol_sliders[i]);
+
+        gtk_box_pack_start (GTK_BOX (vbox), gam_slider_multi->priv->vol_sliders[i], TRUE, TRUE, 0);
+
+        if (channel < G_N_ELEMENTS (channel_names) && channel_names[channel] != NULL)
+            label = gtk_label_new (_(channel_names[channel]));
+        else
+            label = gtk_label_new (snd_mixer_selem_channel_name (channel));
+        gtk_widget_show (label);
+
+        gtk_box_pack_start (GTK_BOX (vbox), label, FALSE, FALSE, 0);
+
+        gtk_box_pack_start (GTK_BOX (hbox), vbox, TRUE, TRUE, 0);
+    }
+
+    gam_slider_add_volume_widget (GAM_SLIDER (gam_slider_multi), hbox);
+
+    if (gam_app_get_slider_toggle_style () == 0)
+        gam_slider_multi->priv->lock_button = gtk_toggle_button_new_with_label (_("Lock"));
+    else
+        gam_slider_multi->priv->lock_button = gtk_check_button_new_with_label (_("Lock"));
+
+    gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (gam_slider_multi->priv->lock_button), TRUE);
+    gtk_widget_show (gam_slider_multi->priv->lock_button);
+
+    gam_slider_add_pan_widget (GAM_SLIDER (gam_slider_multi), gam_slider_multi->priv->lock_button);
+
+    if (gam_slider_multi->priv->n_channels > 0)
+        gtk_label_set_mnemonic_widget (gam_slider_get_label_widget (GAM_SLIDER (gam_slider_multi)),
+                                       gam_slider_multi->priv->vol_sliders[0]);
+
+    return object;
+}
+
+/* all channels in one sweep */
+static void
+gam_slider_multi_read_volumes (GamSliderMulti *gam_slider_multi)
+{
+    guint i;
+
+    gam_element_model_get_normalized_n (gam_slider_get_model (GAM_SLIDER (gam_slider_multi)),
+                                        gam_slider_multi->priv->type,
+                                        gam_slider_multi->priv->channels,
+                                        gam_slider_multi->priv->volumes,
+                                        gam_slider_multi->priv->n_channels);
+
+    for (i = 0; i < gam_slider_multi->priv->n_channels; i++)
+        gam_slider_multi->priv->volumes[i] *= 100;
+}
+
+static void
+gam_slider_multi_show_volume (GamSliderMulti *gam_slider_multi, guint index, gdouble value)
+{
+    const gboolean refreshing = gam_slider_multi->priv->refreshing;
+
+    gam_slider_multi->priv->refreshing = TRUE;
+    gtk_adjustment_set_value (gam_slider_multi->priv->vol_adjustments[index], value);
+    gam_slider_multi->priv->refreshing = refreshing;
+}
+
+/*
+ * When locked, the other sliders follow at once and keep their distance to
+ * the one that moves; every channel is written with the next frame.
+ */
+static gint
+gam_slider_multi_volume_value_changed_cb (GtkAdjustment *adjustment, GamSliderMulti *gam_slider_multi)
+{
+    gdouble value, delta;
+    guint   moved, i;
+
+    if (gam_slider_multi->priv->refreshing)
+        return TRUE;
+
+    for (moved = 0; moved < gam_slider_multi->priv->n_channels; moved++)
+        if (gam_slider_multi->priv->vol_adjustments[moved] == adjustment)
+            break;
+
+    g_return_val_if_fail (moved < gam_slider_multi->priv->n_channels, TRUE);
+
+    value = gtk_adjustment_get_value (adjustment);
+    delta = value - gam_slider_multi->priv->volumes[moved];
+
+    /* round towards the direction of the movement, so every move reaches the next hardware step */
+    gam_slider_multi->priv->dir = delta < 0 ? -1 : 1;
+
+    if (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (gam_slider_multi->priv->lock_button))) {
+        for (i = 0; i < gam_slider_multi->priv->n_channels; i++) {
+            if (i != moved)
+                gam_slider_multi_show_volume (gam_slider_multi, i,
+                                              gam_slider_multi->priv->volumes[i] + delta);
+        }
+    }
+
+    gam_slider_multi->priv->write_pending = TRUE;
+    gam_slider_queue_write (GAM_SLIDER (gam_slider_multi));
+
+    return TRUE;
+}
+
+/*
+ * Writes what every slider shows as one batch; a newer batch replaces one
+ * that still waits for the writer, so the slot is the strip itself.
+ */
+static void
+gam_slider_multi_write (GamSlider *gam_slider)
+{
+    GamSliderMulti * const gam_slider_multi = GAM_SLIDER_MULTI (gam_slider);
+    GamElementModel * const model = gam_slider_get_model (gam_slider);
+    gdouble volumes[VOLUME_MAPPING_MAX_CHANNELS];
+    guint   i;
+
+    if (!gam_slider_multi->priv->write_pending)
+        return;
+
+    gam_slider_multi->priv->write_pending = FALSE;
+
+    for (i = 0; i < gam_slider_multi->priv->n_channels; i++)
+        volumes[i] = gtk_adjustment_get_value (gam_slider_multi->priv->vol_adjustments[i]) / 100;
+
+    gam_slider_post_volume (gam_slider, gam_slider_multi, gam_slider_multi->priv->channels,
+                            volumes, gam_slider_multi->priv->n_channels, gam_slider_multi->priv->dir);
+
+    /* show the hardware steps that were written */
+    for (i = 0; i < gam_slider_multi->priv->n_channels; i++) {
+        gam_slider_multi->priv->volumes[i] = gam_element_model_quantize (model, gam_slider_multi->priv->type,
+                                                                         volumes[i], gam_slider_multi->priv->dir) * 100;
+        gam_slider_multi_show_volume (gam_slider_multi, i, gam_slider_multi->priv->volumes[i]);
+    }
+}
+
+static void
+gam_slider_multi_refresh (GamSlider *gam_slider, guint channels)
+{
+    GamSliderMulti * const gam_slider_multi = GAM_SLIDER_MULTI (gam_slider);
+    guint i;
+
+    gam_slider_multi_read_volumes (gam_slider_multi);
+
+    for (i = 0; i < gam_slider_multi->priv->n_channels; i++)
+        gam_slider_multi_show_volume (gam_slider_multi, i, gam_slider_multi->priv->volumes[i]);
+}
+
+GtkWidget *
+gam_slider_multi_new (gpointer elem, GamMixer *gam_mixer, gboolean playback)
+{
+    g_return_val_if_fail (GAM_IS_MIXER (gam_mixer), NULL);
+
+    return g_object_new (GAM_TYPE_SLIDER_MULTI,
+                         "elem", elem,
+                         "mixer", gam_mixer,
+                         "is-playback", playback,
+                         NULL);
+}
+
+void
+gam_slider_multi_set_size_groups (GamSliderMulti *gam_slider_multi,
+                                  GtkSizeGroup   *pan_size_group,
+                                  GtkSizeGroup   *mute_size_group,
+                                  GtkSizeGroup   *capture_size_group)
+{
+    g_return_if_fail (GAM_IS_SLIDER_MULTI (gam_slider_multi));
+
+    gtk_size_group_add_widget (pan_size_group, gam_slider_multi->priv->lock_button);
+    gtk_size_group_add_widget (mute_size_group, gam_slider_get_mute_widget (GAM_SLIDER (gam_slider_multi)));
+    gtk_size_group_add_widget (capture_size_group, gam_slider_get_capture_widget (GAM_SLIDER (gam_slider_multi)));
+}
@@ -0,0 +1,64 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_SLIDER_MULTI_H__
+#define __GAM_SLIDER_MULTI_H__
+
+#include <alsamixer/gam-mixer.h>
+#include <alsamixer/gam-slider.h>
+
+G_BEGIN_DECLS
+
+#define GAM_TYPE_SLIDER_MULTI            (gam_slider_multi_get_type ())
+#define GAM_SLIDER_MULTI(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GAM_TYPE_SLIDER_MULTI, GamSliderMulti))
+#define GAM_SLIDER_MULTI_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GAM_TYPE_SLIDER_MULTI, GamSliderMultiClass))
+#define GAM_IS_SLIDER_MULTI(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GAM_TYPE_SLIDER_MULTI))
+#define GAM_IS_SLIDER_MULTI_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GAM_TYPE_SLIDER_MULTI))
+#define GAM_SLIDER_MULTI_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GAM_TYPE_SLIDER_MULTI, GamSliderMultiClass))
+
+typedef struct _GamSliderMultiPrivate GamSliderMultiPrivate;
+typedef struct _GamSliderMulti GamSliderMulti;
+typedef struct _GamSliderMultiClass GamSliderMultiClass;
+
+struct _GamSliderMulti
+{
+    GamSlider parent_instance;
+
+    GamSliderMultiPrivate *priv;
+};
+
+struct _GamSliderMultiClass
+{
+    GamSliderClass parent_class;
+};
+
+GType      gam_slider_multi_get_type        (void) G_GNUC_CONST;
+GtkWidget *gam_slider_multi_new             (gpointer        elem,
+                                             GamMixer       *gam_mixer,
+                                             gboolean        playback);
+void       gam_slider_multi_set_size_groups (GamSliderMulti *gam_slider_multi,
+                                             GtkSizeGroup   *pan_size_group,
+                                             GtkSizeGroup   *mute_size_group,
+                                             GtkSizeGroup   *capture_size_group);
+
+G_END_DECLS
+
+#endif /* __GAM_SLIDER_MULTI_H__ */
@@ -23,13 +23,10 @@
 #include <config.h>
 #endif
 
-#include <math.h>
 #include <alsamixer/volume_mapping.h>
 
 #include "gam-slider-pan.h"
-
-/* TODO: move to enum file and rewrite the property */
-enum ctl_dir { PLAYBACK, CAPTURE };
+#include "gam-element-model.h"
 
 struct _GamSliderPanPrivate
 {
@@ -37,35 +34,22 @@ struct _GamSliderPanPrivate
     GtkWidget *vol_slider;
     GtkAdjustment *pan_adjustment;
     GtkAdjustment *vol_adjustment;
+    gdouble        volume;
+    gboolean       refreshing;
     enum ctl_dir   type;
 };
 
-static int (* const is_mono[2])(snd_mixer_elem_t *) = {
-    snd_mixer_selem_is_playback_mono,
-    snd_mixer_selem_is_capture_mono,
-};
-
-static int (* const has_volume[2])(snd_mixer_elem_t *) = {
-    snd_mixer_selem_has_playback_volume,
-    snd_mixer_selem_has_capture_volume,
-};
-
-static double (* const get_normalized_volume[2])(snd_mixer_elem_t *, snd_mixer_selem_channel_id_t) = {
-    get_normalized_playback_volume,
-    get_normalized_capture_volume,
-};
-
-static int (* const set_normalized_volume[2])(snd_mixer_elem_t *, snd_mixer_selem_channel_id_t, double, int) = {
-    set_normalized_playback_volume,
-    set_normalized_capture_volume,
+static const snd_mixer_selem_channel_id_t front_channels[2] = {
+    SND_MIXER_SCHN_FRONT_LEFT,
+    SND_MIXER_SCHN_FRONT_RIGHT,
 };
 
 static void     gam_slider_pan_finalize                (GObject               *object);
 static GObject *gam_slider_pan_constructor             (GType                  type,
                                                         guint                  n_construct_properties,
                                                         GObjectConstructParam *construct_params);
-static gint     gam_slider_pan_get_pan                 (GamSliderPan          *gam_slider_pan);
-static gint     gam_slider_pan_get_volume              (GamSliderPan          *gam_slider_pan);
+static gdouble  gam_slider_pan_get_pan                 (GamSliderPan          *gam_slider_pan);
+static gdouble  gam_slider_pan_get_volume              (GamSliderPan          *gam_slider_pan);
 static void     gam_slider_pan_update_volume           (GamSliderPan          *gam_slider_pan);
 static gint     gam_slider_pan_pan_event_cb            (GtkWidget             *widget,
                                                         GdkEvent              *event,
@@ -74,7 +58,9 @@ static gint     gam_slider_pan_pan_value_changed_cb    (GtkWidget             *w
                                                         GamSliderPan          *gam_slider_pan);
 static gint     gam_slider_pan_volume_value_changed_cb (GtkWidget             *widget,
                                                         GamSliderPan          *gam_slider_pan);
-static void     gam_slider_pan_refresh                 (GamSlider             *gam_slider);
+static void     gam_slider_pan_refresh                 (GamSlider             *gam_slider,
+                                                        guint                  channels);
+static void     gam_slider_pan_write                   (GamSlider             *gam_slider);
 
 static gpointer parent_class;
 
@@ -93,6 +79,7 @@ gam_slider_pan_class_init (GamSliderPanClass *klass)
     gobject_class->constructor = gam_slider_pan_constructor;
 
     object_class->refresh = gam_slider_pan_refresh;
+    object_class->write = gam_slider_pan_write;
 }
 
 static void
@@ -106,6 +93,8 @@ gam_slider_pan_init (GamSliderPan *gam_slider_pan)
     gam_slider_pan->priv->vol_slider = NULL;
     gam_slider_pan->priv->pan_adjustment = NULL;
     gam_slider_pan->priv->vol_adjustment = NULL;
+    gam_slider_pan->priv->volume = 0;
+    gam_slider_pan->priv->refreshing = FALSE;
 }
 
 static void
@@ -145,7 +134,7 @@ gam_slider_pan_constructor (GType                  type,
     else
         gam_slider_pan->priv->type = CAPTURE;
 
-    if (!is_mono[gam_slider_pan->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_pan)))) {
+    if (!gam_slider_get_info (GAM_SLIDER (gam_slider_pan))->is_mono[gam_slider_pan->priv->type]) {
         gam_slider_pan->priv->pan_adjustment = gtk_adjustment_new (gam_slider_pan_get_pan (gam_slider_pan), -100, 100, 1, 5, 1);
 
         g_signal_connect (G_OBJECT (gam_slider_pan->priv->pan_adjustment), "value-changed",
@@ -156,6 +145,7 @@ gam_slider_pan_constructor (GType                  type,
 
         g_signal_connect (G_OBJECT (gam_slider_pan->priv->pan_slider), "event",
                           G_CALLBACK (gam_slider_pan_pan_event_cb), gam_slider_pan);
+        gam_slider_watch_drag (GAM_SLIDER (gam_slider_pan), gam_slider_pan->priv->pan_slider);
     } else
         gam_slider_pan->priv->pan_slider = gtk_label_new (NULL);
 
@@ -163,7 +153,9 @@ gam_slider_pan_constructor (GType                  type,
 
     gam_slider_add_pan_widget (GAM_SLIDER (gam_slider_pan), gam_slider_pan->priv->pan_slider);
 
-    gam_slider_pan->priv->vol_adjustment = gtk_adjustment_new (gam_slider_pan_get_volume (gam_slider_pan), 0, 100, 1, 5, 1);
+    gam_slider_pan->priv->volume = gam_slider_pan_get_volume (gam_slider_pan);
+    gam_slider_pan->priv->vol_adjustment = gam_slider_new_volume_adjustment (GAM_SLIDER (gam_slider_pan),
+                                                                             gam_slider_pan->priv->volume);
 
     g_signal_connect (G_OBJECT (gam_slider_pan->priv->vol_adjustment), "value-changed",
                       G_CALLBACK (gam_slider_pan_volume_value_changed_cb), gam_slider_pan);
@@ -172,6 +164,8 @@ gam_slider_pan_constructor (GType                  type,
     gtk_range_set_inverted (GTK_RANGE (gam_slider_pan->priv->vol_slider), TRUE);
     gtk_widget_show (gam_slider_pan->priv->vol_slider);
     gtk_scale_set_draw_value (GTK_SCALE (gam_slider_pan->priv->vol_slider), FALSE);
+    gam_slider_watch_drag (GAM_SLIDER (gam_slider_pan), gam_slider_pan->priv->vol_slider);
+    gam_slider_watch_steps (GAM_SLIDER (gam_slider_pan), gam_slider_pan->priv->vol_slider);
 
     gam_slider_add_volume_widget (GAM_SLIDER (gam_slider_pan), gam_slider_pan->priv->vol_slider);
 
@@ -181,34 +175,37 @@ gam_slider_pan_constructor (GType                  type,
     return object;
 }
 
-static gint
+/* the model holds the volumes that were asked for, so this gives back the pan that was set */
+static gdouble
 gam_slider_pan_get_pan (GamSliderPan *gam_slider_pan)
 {
     gdouble left_chn, right_chn;
 
-    if (!is_mono[gam_slider_pan->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_pan)))) {
-        left_chn = get_normalized_volume[gam_slider_pan->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_pan)), SND_MIXER_SCHN_FRONT_LEFT);
-        right_chn = get_normalized_volume[gam_slider_pan->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_pan)), SND_MIXER_SCHN_FRONT_RIGHT);
+    if (!gam_slider_get_info (GAM_SLIDER (gam_slider_pan))->is_mono[gam_slider_pan->priv->type]) {
+        gdouble vol[2];
+
+        gam_element_model_get_normalized_n (gam_slider_get_model (GAM_SLIDER (gam_slider_pan)),
+                                            gam_slider_pan->priv->type, front_channels, vol, 2);
+        left_chn = vol[0];
+        right_chn = vol[1];
 
         if ((gam_slider_pan_get_volume (gam_slider_pan) != 0) && (left_chn != right_chn))
-            return rint (((gdouble)(right_chn - left_chn) / (gdouble)MAX(left_chn, right_chn)) * 100);
+            return ((right_chn - left_chn) / MAX (left_chn, right_chn)) * 100;
     }
 
     return 0;
 }
 
-static gint
+static gdouble
 gam_slider_pan_get_volume (GamSliderPan *gam_slider_pan)
 {
-    gdouble left_vol = 0;
-    gdouble right_vol = 0;
-    gboolean mono = is_mono[gam_slider_pan->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_pan)));
+    gdouble vol[2] = { 0, 0 };
+    gboolean mono = gam_slider_get_info (GAM_SLIDER (gam_slider_pan))->is_mono[gam_slider_pan->priv->type];
 
-    left_vol = get_normalized_volume[gam_slider_pan->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_pan)), SND_MIXER_SCHN_FRONT_LEFT);
-    if (mono == FALSE)
-        right_vol = get_normalized_volume[gam_slider_pan->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_pan)), SND_MIXER_SCHN_FRONT_RIGHT);
+    gam_element_model_get_normalized_n (gam_slider_get_model (GAM_SLIDER (gam_slider_pan)),
+                                        gam_slider_pan->priv->type, front_channels, vol, mono ? 1 : 2);
 
-    return lrint (ceil (MAX (left_vol, right_vol) * 100));
+    return MAX (vol[0], vol[1]) * 100;
 }
 
 static void
@@ -216,7 +213,9 @@ gam_slider_pan_update_volume (GamSliderPan *gam_slider_pan)
 {
     gdouble left_vol_value, right_vol_value, vol_value;
     gdouble pan_value;
-    gboolean mono = is_mono[gam_slider_pan->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_pan)));
+    gdouble vol[2];
+    gint dir;
+    gboolean mono = gam_slider_get_info (GAM_SLIDER (gam_slider_pan))->is_mono[gam_slider_pan->priv->type];
 
     /* get values */
     if (gam_slider_pan->priv->vol_adjustment)
@@ -231,21 +230,35 @@ gam_slider_pan_update_volume (GamSliderPan *gam_slider_pan)
 
     left_vol_value = right_vol_value = vol_value;
 
-    /* handle panning */
+    /* handle panning; unrounded, the writer picks the hardware steps */
     if (mono == FALSE) {
         if (pan_value < 0) {
-            right_vol_value = rint (vol_value - ((gfloat)ABS(pan_value) / 100) * vol_value);
+            right_vol_value = vol_value - (ABS (pan_value) / 100) * vol_value;
         } else if (pan_value> 0) {
-            left_vol_value = rint (vol_value - ((gfloat)pan_value / 100) * vol_value);
+            left_vol_value = vol_value - (pan_value / 100) * vol_value;
         }
     }
     left_vol_value /= 100;
     right_vol_value /= 100;
 
-    /* set volume */
-    set_normalized_volume[gam_slider_pan->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_pan)), SND_MIXER_SCHN_FRONT_LEFT, left_vol_value, 1);
-    if (mono == FALSE)
-        set_normalized_volume[gam_slider_pan->priv->type] (gam_slider_get_elem (GAM_SLIDER (gam_slider_pan)), SND_MIXER_SCHN_FRONT_RIGHT, right_vol_value, 1);
+    /* round towards the direction of the movement, so every move reaches the next hardware step */
+    dir = vol_value < gam_slider_pan->priv->volume ? -1 : 1;
+
+    /* set volume; both channels in one call, which is a single write when they are equal */
+    vol[0] = left_vol_value;
+    vol[1] = right_vol_value;
+    gam_slider_post_volume (GAM_SLIDER (gam_slider_pan), gam_slider_pan->priv->vol_adjustment,
+                            front_channels, vol, mono ? 1 : 2, dir);
+
+    /* show the hardware step that was written */
+    gam_slider_pan->priv->volume = gam_element_model_quantize (gam_slider_get_model (GAM_SLIDER (gam_slider_pan)),
+                                                               gam_slider_pan->priv->type,
+                                                               vol_value / 100, dir) * 100;
+    if (gam_slider_pan->priv->vol_adjustment) {
+        gam_slider_pan->priv->refreshing = TRUE;
+        gtk_adjustment_set_value (GTK_ADJUSTMENT (gam_slider_pan->priv->vol_adjustment), gam_slider_pan->priv->volume);
+        gam_slider_pan->priv->refreshing = FALSE;
+    }
 }
 
 static gint
@@ -264,7 +277,10 @@ gam_slider_pan_pan_event_cb (GtkWidget *widget, GdkEvent *event, GamSliderPan *g
 static gint
 gam_slider_pan_pan_value_changed_cb (GtkWidget *widget, GamSliderPan *gam_slider_pan)
 {
-    gam_slider_pan_update_volume (gam_slider_pan);
+    if (gam_slider_pan->priv->refreshing)
+        return TRUE;
+
+    gam_slider_queue_write (GAM_SLIDER (gam_slider_pan));
 
     return TRUE;
 }
@@ -272,29 +288,40 @@ gam_slider_pan_pan_value_changed_cb (GtkWidget *widget, GamSliderPan *gam_slider
 static gint
 gam_slider_pan_volume_value_changed_cb (GtkWidget *widget, GamSliderPan *gam_slider_pan)
 {
-    gam_slider_pan_update_volume (gam_slider_pan);
+    if (gam_slider_pan->priv->refreshing)
+        return TRUE;
+
+    gam_slider_queue_write (GAM_SLIDER (gam_slider_pan));
 
     return TRUE;
 }
 
 static void
-gam_slider_pan_refresh (GamSlider *gam_slider)
+gam_slider_pan_write (GamSlider *gam_slider)
 {
-    GamSliderPan * const gam_slider_pan = GAM_SLIDER_PAN (snd_mixer_elem_get_callback_private (gam_slider_get_elem (gam_slider)));
+    gam_slider_pan_update_volume (GAM_SLIDER_PAN (gam_slider));
+}
 
-    /* disconnect the signal, otherwise a value change outside the app causes a refresh, which sets the value, which calls the callback,
-     * which in turn rounds the value and sets it again system-wide
+static void
+gam_slider_pan_refresh (GamSlider *gam_slider, guint channels)
+{
+    GamSliderPan * const gam_slider_pan = GAM_SLIDER_PAN (gam_slider);
+
+    /* the adjustment holds the exact position of the hardware step, so showing an outside change
+     * must not write it back; the flag keeps the value-changed callbacks quiet meanwhile
      */
-    g_signal_handlers_disconnect_by_data (G_OBJECT (gam_slider_pan->priv->vol_adjustment), gam_slider_pan);
+    gam_slider_pan->priv->refreshing = TRUE;
+
+    gam_slider_pan->priv->volume = gam_slider_pan_get_volume (gam_slider_pan);
     gtk_adjustment_set_value (GTK_ADJUSTMENT (gam_slider_pan->priv->vol_adjustment),
-                              (gdouble) gam_slider_pan_get_volume (gam_slider_pan));
-    g_signal_connect (G_OBJECT (gam_slider_pan->priv->vol_adjustment), "value-changed",
-                      G_CALLBACK (gam_slider_pan_volume_value_changed_cb), gam_slider_pan);
+                              gam_slider_pan->priv->volume);
 
-    if (!snd_mixer_selem_is_playback_mono (gam_slider_get_elem (gam_slider))) {
+    if (!gam_slider_get_info (gam_slider)->is_mono[gam_slider_pan->priv->type]) {
         gtk_adjustment_set_value (GTK_ADJUSTMENT (gam_slider_pan->priv->pan_adjustment),
-                                  (gdouble) gam_slider_pan_get_pan (gam_slider_pan));
+                                  gam_slider_pan_get_pan (gam_slider_pan));
     }
+
+    gam_slider_pan->priv->refreshing = FALSE;
 }
 
 GtkWidget *
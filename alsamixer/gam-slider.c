@@ -23,9 +23,14 @@
 #include <config.h>
 #endif
 
+#include <string.h>
+
 #include <glib/gi18n.h>
 
 #include <alsamixer/gam-slider.h>
+#include <alsamixer/gam-fader.h>
+#include <alsamixer/gam-link.h>
+#include <alsamixer/gam-element-model.h>
 
 enum {
     PROP_0,
@@ -34,24 +39,42 @@ enum {
     PROP_IS_PLAYBACK,
 };
 
-enum {
-    REFRESH,
-    LAST_SIGNAL
-};
-
 struct _GamSliderPrivate
 {
     gpointer          mixer;
     snd_mixer_elem_t *elem;
+    const GamElementInfo *info;
+    GamElementModel  *model;
     gchar            *name;
-    gchar            *name_config;
     gboolean          is_playback;
     GtkWidget        *vbox;
     GtkWidget        *label;
     GtkWidget        *mute_button;
     GtkWidget        *capture_button;
+
+    /* the buttons are being set to what the model has; nothing is written */
+    gboolean          refreshing;
+
+    /* a volume change waiting for the next frame */
+    gboolean          write_pending;
+    guint             write_tick_id;
+
+    /* the level a fade out left, for the fade back in; -1 if none */
+    gdouble           fade_restore;
+
+    /* the undo entry being recorded, and when it was last written to */
+    gpointer          gesture;
+    guint             gesture_timeout_id;
+    gboolean          dragging;
+    gint64            last_write;
 };
 
+/* length of the fades of the slider menu, in milliseconds */
+#define GAM_SLIDER_FADE_TIME 3000
+
+/* a pause in the writes, in milliseconds, that ends an undo entry */
+#define GAM_SLIDER_GESTURE_TIME 500
+
 static void     gam_slider_finalize                  (GObject               *object);
 static GObject *gam_slider_constructor               (GType                  type,
                                                       guint                  n_construct_properties,
@@ -70,13 +93,16 @@ static gint     gam_slider_mute_button_toggled_cb    (GtkWidget             *wid
                                                       GamSlider             *gam_slider);
 static gint     gam_slider_capture_button_toggled_cb (GtkWidget             *widget,
                                                       GamSlider             *gam_slider);
-static gint     gam_slider_refresh                   (snd_mixer_elem_t      *elem,
+static void     gam_slider_refresh                   (GtkWidget             *widget,
                                                       guint                  mask);
+static void     gam_slider_set_model                 (GamSlider             *gam_slider,
+                                                      GamElementModel       *model);
 static gint     gam_slider_get_widget_position       (GamSlider             *gam_slider,
                                                       GtkWidget             *widget);
+static void     gam_slider_unmap                     (GtkWidget             *widget);
+static void     gam_slider_destroy                   (GtkWidget             *widget);
 
 static gpointer parent_class;
-static guint    signals[LAST_SIGNAL] = { 0 };
 
 G_DEFINE_TYPE_WITH_CODE (GamSlider, gam_slider, GTK_TYPE_BOX, G_ADD_PRIVATE (GamSlider))
 
@@ -84,6 +110,7 @@ static void
 gam_slider_class_init (GamSliderClass *klass)
 {
     GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+    GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
     parent_class = g_type_class_peek_parent (klass);
 
@@ -92,14 +119,8 @@ gam_slider_class_init (GamSliderClass *klass)
     gobject_class->set_property = gam_slider_set_property;
     gobject_class->get_property = gam_slider_get_property;
 
-    signals[REFRESH] =
-        g_signal_new ("refresh",
-                      G_OBJECT_CLASS_TYPE (gobject_class),
-                      G_SIGNAL_RUN_FIRST,
-                      G_STRUCT_OFFSET (GamSliderClass, refresh),
-                      NULL, NULL,
-                      g_cclosure_marshal_VOID__VOID,
-                      G_TYPE_NONE, 0);
+    widget_class->unmap = gam_slider_unmap;
+    widget_class->destroy = gam_slider_destroy;
 
     g_object_class_install_property (gobject_class,
                                      PROP_ELEM,
@@ -134,12 +155,21 @@ gam_slider_init (GamSlider *gam_slider)
     gam_slider->priv = gam_slider_get_instance_private (gam_slider);
 
     gam_slider->priv->elem = NULL;
+    gam_slider->priv->model = NULL;
     gam_slider->priv->mixer = NULL;
     gam_slider->priv->vbox = NULL;
     gam_slider->priv->name = NULL;
-    gam_slider->priv->name_config = NULL;
+    gam_slider->priv->info = NULL;
     gam_slider->priv->mute_button = NULL;
     gam_slider->priv->capture_button = NULL;
+    gam_slider->priv->refreshing = FALSE;
+    gam_slider->priv->write_pending = FALSE;
+    gam_slider->priv->write_tick_id = 0;
+    gam_slider->priv->fade_restore = -1;
+    gam_slider->priv->gesture = NULL;
+    gam_slider->priv->gesture_timeout_id = 0;
+    gam_slider->priv->dragging = FALSE;
+    gam_slider->priv->last_write = 0;
 }
 
 static void
@@ -151,13 +181,15 @@ gam_slider_finalize (GObject *object)
 
     gam_slider = GAM_SLIDER (object);
 
-    snd_mixer_elem_set_callback (gam_slider->priv->elem, NULL);
+    if (gam_slider->priv->mixer && gam_slider->priv->elem)
+        gam_mixer_unsubscribe (GAM_MIXER (gam_slider->priv->mixer), gam_slider->priv->elem, GTK_WIDGET (gam_slider));
+
+    gam_slider_set_model (gam_slider, NULL);
 
     g_free (gam_slider->priv->name);
-    g_free (gam_slider->priv->name_config);
 
     gam_slider->priv->name = NULL;
-    gam_slider->priv->name_config = NULL;
+    gam_slider->priv->info = NULL;
     gam_slider->priv->label = NULL;
     gam_slider->priv->mute_button = NULL;
     gam_slider->priv->capture_button = NULL;
@@ -185,6 +217,13 @@ gam_slider_constructor (GType                  type,
 
     gam_slider = GAM_SLIDER (object);
 
+    gam_mixer_subscribe (GAM_MIXER (gam_slider->priv->mixer), gam_slider->priv->elem,
+                         GTK_WIDGET (gam_slider), gam_slider_refresh);
+    gam_slider_set_model (gam_slider, gam_mixer_get_model (GAM_MIXER (gam_slider->priv->mixer),
+                                                           gam_slider->priv->elem));
+    gam_slider->priv->info = gam_mixer_get_elem_info (GAM_MIXER (gam_slider->priv->mixer),
+                                                      gam_slider->priv->elem);
+
     gam_slider->priv->vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
     gtk_widget_show (gam_slider->priv->vbox);
 
@@ -205,13 +244,13 @@ gam_slider_constructor (GType                  type,
     gtk_box_pack_start (GTK_BOX (gam_slider->priv->vbox),
                         gam_slider->priv->label, FALSE, TRUE, 0);
 
-    if (snd_mixer_selem_has_playback_switch (gam_slider->priv->elem)) {
+    if (gam_slider->priv->info->has_switch[PLAYBACK]) {
         if (gam_app_get_slider_toggle_style () == 0)
             gam_slider->priv->mute_button = gtk_toggle_button_new_with_label (_("Mute"));
         else
             gam_slider->priv->mute_button = gtk_check_button_new_with_label (_("Mute"));
 
-        snd_mixer_selem_get_playback_switch (gam_slider->priv->elem, SND_MIXER_SCHN_FRONT_LEFT, &value);
+        value = gam_element_model_get_switch (gam_slider->priv->model, PLAYBACK, SND_MIXER_SCHN_FRONT_LEFT);
         gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (gam_slider->priv->mute_button), !value);
 
         g_signal_connect (G_OBJECT (gam_slider->priv->mute_button), "toggled",
@@ -223,13 +262,13 @@ gam_slider_constructor (GType                  type,
     gtk_box_pack_start (GTK_BOX (gam_slider->priv->vbox),
                         gam_slider->priv->mute_button, FALSE, FALSE, 0);
 
-    if (snd_mixer_selem_has_capture_switch (gam_slider->priv->elem)) {
+    if (gam_slider->priv->info->has_switch[CAPTURE]) {
         if (gam_app_get_slider_toggle_style () == 0)
             gam_slider->priv->capture_button = gtk_toggle_button_new_with_label (_("Rec."));
         else
             gam_slider->priv->capture_button = gtk_check_button_new_with_label (_("Rec."));
 
-        snd_mixer_selem_get_capture_switch (gam_slider->priv->elem, SND_MIXER_SCHN_FRONT_LEFT, &value);
+        value = gam_element_model_get_switch (gam_slider->priv->model, CAPTURE, SND_MIXER_SCHN_FRONT_LEFT);
         gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (gam_slider->priv->capture_button), value);
 
         g_signal_connect (G_OBJECT (gam_slider->priv->capture_button), "toggled",
@@ -302,12 +341,15 @@ gam_slider_set_elem (GamSlider *gam_slider, snd_mixer_elem_t *elem)
 {
     g_return_if_fail (GAM_IS_SLIDER (gam_slider));
 
-    if (gam_slider->priv->elem)
-        snd_mixer_elem_set_callback (gam_slider->priv->elem, NULL);
+    /* before construction the mixer may not be known yet; the constructor subscribes then */
+    if (gam_slider->priv->mixer && gam_slider->priv->elem)
+        gam_mixer_unsubscribe (GAM_MIXER (gam_slider->priv->mixer), gam_slider->priv->elem, GTK_WIDGET (gam_slider));
 
-    if (elem) {
-        snd_mixer_elem_set_callback_private (elem, gam_slider);
-        snd_mixer_elem_set_callback (elem, gam_slider_refresh);
+    if (gam_slider->priv->mixer && elem) {
+        gam_mixer_subscribe (GAM_MIXER (gam_slider->priv->mixer), elem, GTK_WIDGET (gam_slider), gam_slider_refresh);
+
+        gam_slider_set_model (gam_slider, gam_mixer_get_model (GAM_MIXER (gam_slider->priv->mixer), elem));
+        gam_slider->priv->info = gam_mixer_get_elem_info (GAM_MIXER (gam_slider->priv->mixer), elem);
     }
 
     gam_slider->priv->elem = elem;
@@ -315,11 +357,83 @@ gam_slider_set_elem (GamSlider *gam_slider, snd_mixer_elem_t *elem)
     g_object_notify (G_OBJECT (gam_slider), "elem");
 }
 
+static void
+gam_slider_volume_changed_cb (GamElementModel *model, gint dir, guint channels, GamSlider *gam_slider)
+{
+    GamSliderClass * const klass = GAM_SLIDER_GET_CLASS (gam_slider);
+
+    if (dir != (gam_slider->priv->is_playback ? PLAYBACK : CAPTURE))
+        return;
+
+    /* the volume being dragged wins; it is written with the next frame */
+    if (gam_slider->priv->write_pending)
+        return;
+
+    if (klass->refresh)
+        klass->refresh (gam_slider, channels);
+}
+
+/* the buttons show the first channel */
+static void
+gam_slider_switch_changed_cb (GamElementModel *model, gint dir, guint channels, GamSlider *gam_slider)
+{
+    if (channels & (1u << SND_MIXER_SCHN_FRONT_LEFT))
+        gam_slider_update (gam_slider, 0);
+}
+
+/* the views of the model's element follow its signals, not the mixer's events */
+static void
+gam_slider_set_model (GamSlider *gam_slider, GamElementModel *model)
+{
+    if (gam_slider->priv->model) {
+        g_signal_handlers_disconnect_by_data (gam_slider->priv->model, gam_slider);
+        g_clear_object (&gam_slider->priv->model);
+    }
+
+    if (model == NULL)
+        return;
+
+    gam_slider->priv->model = g_object_ref (model);
+
+    g_signal_connect (G_OBJECT (model), "volume_changed",
+                      G_CALLBACK (gam_slider_volume_changed_cb), gam_slider);
+    g_signal_connect (G_OBJECT (model), "switch_changed",
+                      G_CALLBACK (gam_slider_switch_changed_cb), gam_slider);
+}
+
+/* a write that failed leaves the widgets showing what the hardware has */
+static void
+gam_slider_write_failed (GtkWidget *view, gint err)
+{
+    GamSlider * const gam_slider = GAM_SLIDER (view);
+
+    g_warning ("%s: %s", gam_slider_get_name (gam_slider), snd_strerror (err));
+
+    gam_slider_update (gam_slider, gam_slider->priv->info->channels[gam_slider->priv->is_playback ? PLAYBACK : CAPTURE]);
+}
+
+static gint
+gam_slider_write_playback_switch (snd_mixer_elem_t *elem, gpointer data)
+{
+    return snd_mixer_selem_set_playback_switch_all (elem, GPOINTER_TO_INT (data));
+}
+
+static gint
+gam_slider_write_capture_switch (snd_mixer_elem_t *elem, gpointer data)
+{
+    return snd_mixer_selem_set_capture_switch_all (elem, GPOINTER_TO_INT (data));
+}
+
 static gint
 gam_slider_mute_button_toggled_cb (GtkWidget *widget, GamSlider *gam_slider)
 {
-    snd_mixer_selem_set_playback_switch_all (gam_slider->priv->elem,
-                !gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (widget)));
+    if (gam_slider->priv->refreshing)
+        return TRUE;
+
+    gam_mixer_post_write (GAM_MIXER (gam_slider->priv->mixer), gam_slider->priv->elem,
+                          GTK_WIDGET (gam_slider), widget, gam_slider_write_playback_switch,
+                          GINT_TO_POINTER (!gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (widget))),
+                          NULL, gam_slider_write_failed);
 
     return TRUE;
 }
@@ -327,8 +441,13 @@ gam_slider_mute_button_toggled_cb (GtkWidget *widget, GamSlider *gam_slider)
 static gint
 gam_slider_capture_button_toggled_cb (GtkWidget *widget, GamSlider *gam_slider)
 {
-    snd_mixer_selem_set_capture_switch_all (gam_slider->priv->elem,
-                gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (widget)));
+    if (gam_slider->priv->refreshing)
+        return TRUE;
+
+    gam_mixer_post_write (GAM_MIXER (gam_slider->priv->mixer), gam_slider->priv->elem,
+                          GTK_WIDGET (gam_slider), widget, gam_slider_write_capture_switch,
+                          GINT_TO_POINTER (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (widget))),
+                          NULL, gam_slider_write_failed);
 
     return TRUE;
 }
@@ -355,24 +474,51 @@ gam_slider_get_widget_position (GamSlider *gam_slider, GtkWidget *widget)
 }
 
 
-static gint
-gam_slider_refresh (snd_mixer_elem_t *elem, guint mask)
+static void
+gam_slider_refresh (GtkWidget *widget, guint mask)
+{
+    GamSlider * const gam_slider = GAM_SLIDER (widget);
+
+    /* the element is about to be freed; the values come from the model */
+    if (mask == SND_CTL_EVENT_MASK_REMOVE)
+        gtk_widget_hide (widget);
+}
+
+/* shows the switches, and the volumes of 'channels', as the model has them */
+void
+gam_slider_update (GamSlider *gam_slider, guint channels)
 {
-    GamSlider * const gam_slider = GAM_SLIDER (snd_mixer_elem_get_callback_private (elem));
+    GamSliderClass *klass;
     gint value;
 
-    if (snd_mixer_selem_has_playback_switch (gam_slider->priv->elem)) {
-        snd_mixer_selem_get_playback_switch (gam_slider->priv->elem, SND_MIXER_SCHN_FRONT_LEFT, &value);
+    g_return_if_fail (GAM_IS_SLIDER (gam_slider));
+
+    /*
+     * Showing the hardware state must not write it back, or it would replace
+     * a click still waiting for the writer; the flag keeps the toggled
+     * callbacks quiet meanwhile.
+     */
+    gam_slider->priv->refreshing = TRUE;
+
+    if (gam_slider->priv->info->has_switch[PLAYBACK]) {
+        value = gam_element_model_get_switch (gam_slider->priv->model, PLAYBACK, SND_MIXER_SCHN_FRONT_LEFT);
         gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (gam_slider->priv->mute_button), !value);
     }
 
-    if (snd_mixer_selem_has_capture_switch (gam_slider->priv->elem)) {
-        snd_mixer_selem_get_capture_switch (gam_slider->priv->elem, SND_MIXER_SCHN_FRONT_LEFT, &value);
+    if (gam_slider->priv->info->has_switch[CAPTURE]) {
+        value = gam_element_model_get_switch (gam_slider->priv->model, CAPTURE, SND_MIXER_SCHN_FRONT_LEFT);
         gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (gam_slider->priv->capture_button), value);
     }
 
-    g_signal_emit (gam_slider, signals[REFRESH], 0);
-    return 0;
+    gam_slider->priv->refreshing = FALSE;
+
+    /* the volume being dragged wins; it is written with the next frame */
+    if (channels == 0 || gam_slider->priv->write_pending)
+        return;
+
+    klass = GAM_SLIDER_GET_CLASS (gam_slider);
+    if (klass->refresh)
+        klass->refresh (gam_slider, channels);
 }
 
 const gchar *
@@ -380,7 +526,7 @@ gam_slider_get_name (GamSlider *gam_slider)
 {
     g_return_val_if_fail (GAM_IS_SLIDER (gam_slider), NULL);
 
-    return snd_mixer_selem_get_name (gam_slider->priv->elem);
+    return g_quark_to_string (gam_slider->priv->info->name);
     
 }
 
@@ -389,12 +535,7 @@ gam_slider_get_config_name (GamSlider *gam_slider)
 {
     g_return_val_if_fail (GAM_IS_SLIDER (gam_slider), NULL);
 
-//    if (gam_slider->priv->name_config == NULL) {
-        gam_slider->priv->name_config = g_strdup (gam_slider_get_name (gam_slider));
-        gam_slider->priv->name_config = g_strdelimit (gam_slider->priv->name_config, GAM_CONFIG_DELIMITERS, '_');
-//    }
-
-    return gam_slider->priv->name_config;
+    return g_quark_to_string (gam_slider->priv->info->config_name);
 }
 
 gchar *
@@ -448,6 +589,39 @@ gam_slider_get_elem (GamSlider *gam_slider)
     return gam_slider->priv->elem;
 }
 
+const GamElementInfo *
+gam_slider_get_info (GamSlider *gam_slider)
+{
+    g_return_val_if_fail (GAM_IS_SLIDER (gam_slider), NULL);
+
+    return gam_slider->priv->info;
+}
+
+GamElementModel *
+gam_slider_get_model (GamSlider *gam_slider)
+{
+    g_return_val_if_fail (GAM_IS_SLIDER (gam_slider), NULL);
+
+    return gam_slider->priv->model;
+}
+
+enum ctl_dir
+gam_slider_get_direction (GamSlider *gam_slider)
+{
+    g_return_val_if_fail (GAM_IS_SLIDER (gam_slider), PLAYBACK);
+
+    return gam_slider->priv->is_playback ? PLAYBACK : CAPTURE;
+}
+
+/* the steps of the keys are taken over by gam_slider_watch_steps () */
+GtkAdjustment *
+gam_slider_new_volume_adjustment (GamSlider *gam_slider, gdouble value)
+{
+    g_return_val_if_fail (GAM_IS_SLIDER (gam_slider), NULL);
+
+    return gtk_adjustment_new (value, 0, 100, 1, 5, 0);
+}
+
 GtkLabel *
 gam_slider_get_label_widget (GamSlider *gam_slider)
 {
@@ -499,3 +673,497 @@ gam_slider_add_volume_widget (GamSlider *gam_slider, GtkWidget *widget)
 
     gtk_box_reorder_child (GTK_BOX (gam_slider->priv->vbox), widget, 1);
 }
+
+static gboolean
+gam_slider_write_tick (GtkWidget     *widget,
+                       GdkFrameClock *frame_clock,
+                       gpointer       data)
+{
+    GamSlider * const gam_slider = GAM_SLIDER (widget);
+
+    gam_slider->priv->write_tick_id = 0;
+    gam_slider_flush_write (gam_slider);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * A drag changes the adjustments far more often than the screen, or a slow
+ * USB mixer, can follow.  Volume changes are therefore only noted here, and
+ * the latest one is written once per frame, and when the drag ends.
+ */
+void
+gam_slider_queue_write (GamSlider *gam_slider)
+{
+    g_return_if_fail (GAM_IS_SLIDER (gam_slider));
+
+    /* a hand on the slider takes over from a fade */
+    gam_fader_stop (gam_slider);
+
+    gam_slider->priv->write_pending = TRUE;
+
+    /* no frames come for a widget that is not on screen */
+    if (!gtk_widget_get_mapped (GTK_WIDGET (gam_slider))) {
+        gam_slider_flush_write (gam_slider);
+        return;
+    }
+
+    if (gam_slider->priv->write_tick_id == 0)
+        gam_slider->priv->write_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (gam_slider),
+                                                                        gam_slider_write_tick,
+                                                                        NULL, NULL);
+}
+
+static void
+gam_slider_end_gesture (GamSlider *gam_slider)
+{
+    if (gam_slider->priv->gesture_timeout_id) {
+        g_source_remove (gam_slider->priv->gesture_timeout_id);
+        gam_slider->priv->gesture_timeout_id = 0;
+    }
+
+    if (gam_slider->priv->gesture == NULL)
+        return;
+
+    gam_mixer_end_gesture (GAM_MIXER (gam_slider->priv->mixer), gam_slider->priv->gesture);
+    gam_slider->priv->gesture = NULL;
+}
+
+static gboolean
+gam_slider_gesture_timeout (gpointer data)
+{
+    GamSlider * const gam_slider = GAM_SLIDER (data);
+
+    if (gam_slider->priv->dragging ||
+        g_get_monotonic_time () - gam_slider->priv->last_write < GAM_SLIDER_GESTURE_TIME * 1000)
+        return G_SOURCE_CONTINUE;
+
+    gam_slider->priv->gesture_timeout_id = 0;
+    gam_slider_end_gesture (gam_slider);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * A drag, or a run of scroll steps and key presses with no pause longer
+ * than GAM_SLIDER_GESTURE_TIME between them, is one entry of the history.
+ */
+static void
+gam_slider_note_gesture (GamSlider *gam_slider)
+{
+    gam_slider->priv->last_write = g_get_monotonic_time ();
+
+    if (gam_slider->priv->gesture)
+        return;
+
+    gam_slider->priv->gesture = gam_mixer_begin_gesture (GAM_MIXER (gam_slider->priv->mixer),
+                                                         gam_slider->priv->elem,
+                                                         gam_slider->priv->is_playback);
+    if (gam_slider->priv->gesture == NULL)
+        return;
+
+    gam_slider->priv->gesture_timeout_id = g_timeout_add (GAM_SLIDER_GESTURE_TIME,
+                                                          gam_slider_gesture_timeout,
+                                                          gam_slider);
+}
+
+void
+gam_slider_flush_write (GamSlider *gam_slider)
+{
+    GamSliderClass *klass;
+
+    g_return_if_fail (GAM_IS_SLIDER (gam_slider));
+
+    if (!gam_slider->priv->write_pending)
+        return;
+
+    gam_slider->priv->write_pending = FALSE;
+
+    /* the removal is on its way */
+    if (gam_mixer_get_elem_info (GAM_MIXER (gam_slider->priv->mixer), gam_slider->priv->elem) == NULL)
+        return;
+
+    gam_slider_note_gesture (gam_slider);
+
+    /* the write only reads the model; the writer thread does the rest */
+    klass = GAM_SLIDER_GET_CLASS (gam_slider);
+    if (klass->write)
+        klass->write (gam_slider);
+}
+
+static gboolean
+gam_slider_drag_end_cb (GtkWidget *widget, GdkEvent *event, GamSlider *gam_slider)
+{
+    gam_slider_flush_write (gam_slider);
+
+    if (gam_slider->priv->dragging) {
+        gam_slider->priv->dragging = FALSE;
+        gam_slider_end_gesture (gam_slider);
+    }
+
+    return FALSE;
+}
+
+/* the loudest channel, which a fade back in returns to */
+static gdouble
+gam_slider_get_level (GamSlider *gam_slider)
+{
+    const enum ctl_dir dir = gam_slider->priv->is_playback ? PLAYBACK : CAPTURE;
+    snd_mixer_selem_channel_id_t channels[VOLUME_MAPPING_MAX_CHANNELS];
+    gdouble volumes[VOLUME_MAPPING_MAX_CHANNELS], level = 0;
+    guint count, i;
+
+    count = gam_element_model_get_channels (gam_slider->priv->model, dir, channels);
+    gam_element_model_get_normalized_n (gam_slider->priv->model, dir, channels, volumes, count);
+
+    for (i = 0; i < count; i++)
+        level = MAX (level, volumes[i]);
+
+    return level;
+}
+
+static void
+gam_slider_fade_out_cb (GtkWidget *widget, GamSlider *gam_slider)
+{
+    gam_slider->priv->fade_restore = gam_slider_get_level (gam_slider);
+
+    gam_fader_start (gam_slider, 0, GAM_SLIDER_FADE_TIME, VOLUME_FADE_SMOOTH);
+}
+
+static void
+gam_slider_fade_in_cb (GtkWidget *widget, GamSlider *gam_slider)
+{
+    gam_fader_start (gam_slider, gam_slider->priv->fade_restore, GAM_SLIDER_FADE_TIME,
+                     VOLUME_FADE_SMOOTH);
+}
+
+static void
+gam_slider_stop_fade_cb (GtkWidget *widget, GamSlider *gam_slider)
+{
+    gam_fader_stop (gam_slider);
+}
+
+static GtkWidget *
+gam_slider_fade_dlg_attach (GtkGrid *grid, gint row, const gchar *text, GtkWidget *widget)
+{
+    GtkWidget *label;
+
+    label = gtk_label_new_with_mnemonic (text);
+    gtk_label_set_mnemonic_widget (GTK_LABEL (label), widget);
+    gtk_widget_set_halign (label, GTK_ALIGN_START);
+    gtk_grid_attach (grid, label, 0, row, 1, 1);
+    gtk_grid_attach (grid, widget, 1, row, 1, 1);
+
+    return widget;
+}
+
+/* today at 'hour':'minute', or tomorrow if that is past already */
+static GDateTime *
+gam_slider_fade_dlg_get_start (gint hour, gint minute)
+{
+    GDateTime *now, *start, *next;
+
+    now = g_date_time_new_now_local ();
+    start = g_date_time_new_local (g_date_time_get_year (now), g_date_time_get_month (now),
+                                   g_date_time_get_day_of_month (now), hour, minute, 0);
+
+    if (g_date_time_compare (start, now) < 0) {
+        next = g_date_time_add_days (start, 1);
+        g_date_time_unref (start);
+        start = next;
+    }
+
+    g_date_time_unref (now);
+
+    return start;
+}
+
+/*
+ * The fade of the menu items, with its level, length and curve chosen, and
+ * optionally a time of day to start it at.
+ */
+static void
+gam_slider_fade_dlg_cb (GtkWidget *widget, GamSlider *gam_slider)
+{
+    GtkWidget *dialog, *grid, *level, *duration, *curve, *at, *hbox, *hour, *minute;
+    GDateTime *now, *start = NULL;
+
+    dialog = gtk_dialog_new_with_buttons (_("Fade"),
+                                          GTK_WINDOW (gtk_widget_get_toplevel (GTK_WIDGET (gam_slider))),
+                                          GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+                                          _("_Cancel"), GTK_RESPONSE_CANCEL,
+                                          _("_Start"), GTK_RESPONSE_ACCEPT,
+                                          NULL);
+    gtk_dialog_set_default_response (GTK_DIALOG (dialog), GTK_RESPONSE_ACCEPT);
+
+    grid = gtk_grid_new ();
+    gtk_grid_set_row_spacing (GTK_GRID (grid), 6);
+    gtk_grid_set_column_spacing (GTK_GRID (grid), 12);
+    gtk_container_set_border_width (GTK_CONTAINER (grid), 6);
+    gtk_box_pack_start (GTK_BOX (gtk_dialog_get_content_area (GTK_DIALOG (dialog))), grid, TRUE, TRUE, 0);
+
+    level = gam_slider_fade_dlg_attach (GTK_GRID (grid), 0, _("_Level (%):"),
+                                        gtk_spin_button_new_with_range (0, 100, 1));
+    gtk_spin_button_set_value (GTK_SPIN_BUTTON (level), 0);
+
+    duration = gam_slider_fade_dlg_attach (GTK_GRID (grid), 1, _("_Duration (s):"),
+                                           gtk_spin_button_new_with_range (0, 3600, 1));
+    gtk_spin_button_set_value (GTK_SPIN_BUTTON (duration), GAM_SLIDER_FADE_TIME / 1000);
+
+    /* in the order of enum volume_fade_curve */
+    curve = gam_slider_fade_dlg_attach (GTK_GRID (grid), 2, _("_Curve:"), gtk_combo_box_text_new ());
+    gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (curve), _("Linear"));
+    gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (curve), _("Smooth"));
+    gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (curve), _("Ease in"));
+    gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (curve), _("Ease out"));
+    gtk_combo_box_set_active (GTK_COMBO_BOX (curve), VOLUME_FADE_SMOOTH);
+
+    now = g_date_time_new_now_local ();
+    hbox = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 6);
+    hour = gtk_spin_button_new_with_range (0, 23, 1);
+    gtk_spin_button_set_value (GTK_SPIN_BUTTON (hour), g_date_time_get_hour (now));
+    gtk_box_pack_start (GTK_BOX (hbox), hour, FALSE, FALSE, 0);
+    minute = gtk_spin_button_new_with_range (0, 59, 1);
+    gtk_spin_button_set_value (GTK_SPIN_BUTTON (minute), g_date_time_get_minute (now));
+    gtk_box_pack_start (GTK_BOX (hbox), minute, FALSE, FALSE, 0);
+    g_date_time_unref (now);
+
+    at = gtk_check_button_new_with_mnemonic (_("Start _at:"));
+    g_object_bind_property (at, "active", hbox, "sensitive", G_BINDING_SYNC_CREATE);
+    gtk_grid_attach (GTK_GRID (grid), at, 0, 3, 1, 1);
+    gtk_grid_attach (GTK_GRID (grid), hbox, 1, 3, 1, 1);
+
+    gtk_widget_show_all (grid);
+
+    /* the card may go away while the dialog runs */
+    g_object_ref (gam_slider);
+
+    if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT &&
+        !gtk_widget_in_destruction (GTK_WIDGET (gam_slider))) {
+        const gdouble target = gtk_spin_button_get_value (GTK_SPIN_BUTTON (level)) / 100;
+
+        if (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (at)))
+            start = gam_slider_fade_dlg_get_start (gtk_spin_button_get_value_as_int (GTK_SPIN_BUTTON (hour)),
+                                                   gtk_spin_button_get_value_as_int (GTK_SPIN_BUTTON (minute)));
+
+        /* a fade down can be undone from the menu, as a fade out can */
+        if (target < gam_slider_get_level (gam_slider))
+            gam_slider->priv->fade_restore = gam_slider_get_level (gam_slider);
+
+        gam_fader_start_at (gam_slider, target,
+                            gtk_spin_button_get_value_as_int (GTK_SPIN_BUTTON (duration)) * 1000,
+                            gtk_combo_box_get_active (GTK_COMBO_BOX (curve)), start);
+
+        if (start != NULL)
+            g_date_time_unref (start);
+    }
+
+    gtk_widget_destroy (dialog);
+    g_object_unref (gam_slider);
+}
+
+static void
+gam_slider_popup_fade_menu (GamSlider *gam_slider, GdkEvent *event)
+{
+    GtkWidget *menu, *item;
+
+    menu = gtk_menu_new ();
+
+    item = gtk_menu_item_new_with_mnemonic (_("Fade _Out"));
+    g_signal_connect (G_OBJECT (item), "activate", G_CALLBACK (gam_slider_fade_out_cb), gam_slider);
+    gtk_menu_shell_append (GTK_MENU_SHELL (menu), item);
+
+    item = gtk_menu_item_new_with_mnemonic (_("Fade _In"));
+    gtk_widget_set_sensitive (item, gam_slider->priv->fade_restore >= 0);
+    g_signal_connect (G_OBJECT (item), "activate", G_CALLBACK (gam_slider_fade_in_cb), gam_slider);
+    gtk_menu_shell_append (GTK_MENU_SHELL (menu), item);
+
+    item = gtk_menu_item_new_with_mnemonic (_("_Fade..."));
+    g_signal_connect (G_OBJECT (item), "activate", G_CALLBACK (gam_slider_fade_dlg_cb), gam_slider);
+    gtk_menu_shell_append (GTK_MENU_SHELL (menu), item);
+
+    item = gtk_menu_item_new_with_mnemonic (_("_Stop Fade"));
+    gtk_widget_set_sensitive (item, gam_fader_is_fading (gam_slider));
+    g_signal_connect (G_OBJECT (item), "activate", G_CALLBACK (gam_slider_stop_fade_cb), gam_slider);
+    gtk_menu_shell_append (GTK_MENU_SHELL (menu), item);
+
+    gtk_widget_show_all (menu);
+    gtk_menu_attach_to_widget (GTK_MENU (menu), GTK_WIDGET (gam_slider), NULL);
+    g_signal_connect (G_OBJECT (menu), "deactivate", G_CALLBACK (gtk_widget_destroy), NULL);
+
+    gtk_menu_popup_at_pointer (GTK_MENU (menu), event);
+}
+
+static gboolean
+gam_slider_button_press_cb (GtkWidget *widget, GdkEvent *event, GamSlider *gam_slider)
+{
+    if (gdk_event_triggers_context_menu (event)) {
+        gam_slider_popup_fade_menu (gam_slider, event);
+        return TRUE;
+    }
+
+    if (event->button.button == 1)
+        gam_slider->priv->dragging = TRUE;
+
+    return FALSE;
+}
+
+/*
+ * The last value of a drag is written as soon as the button is released;
+ * the context menu of the slider starts and stops fades.
+ */
+void
+gam_slider_watch_drag (GamSlider *gam_slider, GtkWidget *range)
+{
+    g_return_if_fail (GAM_IS_SLIDER (gam_slider));
+
+    g_signal_connect (G_OBJECT (range), "button-press-event",
+                      G_CALLBACK (gam_slider_button_press_cb), gam_slider);
+    g_signal_connect (G_OBJECT (range), "button-release-event",
+                      G_CALLBACK (gam_slider_drag_end_cb), gam_slider);
+}
+
+static gboolean
+gam_slider_change_value_cb (GtkRange *range, GtkScrollType scroll, gdouble value, GamSlider *gam_slider)
+{
+    GtkAdjustment *adjustment;
+    gdouble current;
+
+    switch (scroll) {
+        case GTK_SCROLL_STEP_BACKWARD:
+        case GTK_SCROLL_STEP_FORWARD:
+        case GTK_SCROLL_STEP_UP:
+        case GTK_SCROLL_STEP_DOWN:
+        case GTK_SCROLL_STEP_LEFT:
+        case GTK_SCROLL_STEP_RIGHT:
+            break;
+        default:
+            return FALSE;
+    }
+
+    adjustment = gtk_range_get_adjustment (range);
+    current = gtk_adjustment_get_value (adjustment);
+    if (value == current)
+        return TRUE;
+
+    gtk_adjustment_set_value (adjustment,
+                              gam_element_model_step (gam_slider->priv->model,
+                                                      gam_slider->priv->is_playback ? PLAYBACK : CAPTURE,
+                                                      current / 100, value > current ? 1 : -1) * 100);
+
+    return TRUE;
+}
+
+/*
+ * A key step of a volume scale moves to the next hardware step; the steps of
+ * a dB table are not evenly spread over the slider, so no fixed increment
+ * would hit each of them.
+ */
+void
+gam_slider_watch_steps (GamSlider *gam_slider, GtkWidget *range)
+{
+    g_return_if_fail (GAM_IS_SLIDER (gam_slider));
+
+    g_signal_connect (G_OBJECT (range), "change-value",
+                      G_CALLBACK (gam_slider_change_value_cb), gam_slider);
+}
+
+static void
+gam_slider_unmap (GtkWidget *widget)
+{
+    GamSlider * const gam_slider = GAM_SLIDER (widget);
+
+    gam_slider_flush_write (gam_slider);
+    gam_slider->priv->dragging = FALSE;
+    gam_slider_end_gesture (gam_slider);
+
+    GTK_WIDGET_CLASS (parent_class)->unmap (widget);
+}
+
+static void
+gam_slider_destroy (GtkWidget *widget)
+{
+    GamSlider * const gam_slider = GAM_SLIDER (widget);
+
+    gam_fader_stop (gam_slider);
+
+    if (gam_slider->priv->mixer)
+        gam_slider_end_gesture (gam_slider);
+
+    if (gam_slider->priv->mixer)
+        gam_mixer_cancel_writes (GAM_MIXER (gam_slider->priv->mixer), widget);
+
+    /* the model may outlive us in the other views of the element */
+    if (gam_slider->priv->model)
+        g_signal_handlers_disconnect_by_data (gam_slider->priv->model, gam_slider);
+
+    GTK_WIDGET_CLASS (parent_class)->destroy (widget);
+}
+
+typedef struct
+{
+    GamElementModel              *model;
+    struct volume_mapping        *mapping;
+    snd_mixer_selem_channel_id_t  channels[GAM_SLIDER_MAX_WRITE_CHANNELS];
+    gdouble                       volumes[GAM_SLIDER_MAX_WRITE_CHANNELS];
+    guint                         count;
+    gint                          dir;
+} GamSliderVolumeWrite;
+
+static gint
+gam_slider_write_volume (snd_mixer_elem_t *elem, gpointer data)
+{
+    GamSliderVolumeWrite * const write = data;
+
+    return volume_mapping_set_normalized_n (write->mapping, write->channels, write->volumes,
+                                            write->count, write->dir);
+}
+
+/* the model keeps the mapping for as long as the write needs it */
+static void
+gam_slider_volume_write_free (gpointer data)
+{
+    GamSliderVolumeWrite * const write = data;
+
+    g_object_unref (write->model);
+    g_free (write);
+}
+
+/*
+ * Hands normalized volumes for some channels to the writer thread; 'slot'
+ * is the control they come from, a newer write from it replaces this one
+ * while it waits.  The model keeps the exact volumes for the views, and the
+ * other members of a link group follow.
+ */
+void
+gam_slider_post_volume (GamSlider                          *gam_slider,
+                        gpointer                            slot,
+                        const snd_mixer_selem_channel_id_t *channels,
+                        const gdouble                      *volumes,
+                        guint                               count,
+                        gint                                dir)
+{
+    GamSliderVolumeWrite *write;
+
+    g_return_if_fail (GAM_IS_SLIDER (gam_slider));
+    g_return_if_fail (count <= GAM_SLIDER_MAX_WRITE_CHANNELS);
+
+    write = g_new (GamSliderVolumeWrite, 1);
+    write->model = g_object_ref (gam_slider->priv->model);
+    write->mapping = gam_element_model_get_mapping (gam_slider->priv->model,
+                                                    gam_slider->priv->is_playback ? PLAYBACK : CAPTURE);
+    memcpy (write->channels, channels, count * sizeof (*channels));
+    memcpy (write->volumes, volumes, count * sizeof (*volumes));
+    write->count = count;
+    write->dir = dir;
+
+    gam_mixer_post_write (GAM_MIXER (gam_slider->priv->mixer), gam_slider->priv->elem,
+                          GTK_WIDGET (gam_slider), slot, gam_slider_write_volume,
+                          write, gam_slider_volume_write_free, gam_slider_write_failed);
+
+    gam_element_model_request (gam_slider->priv->model, gam_slider->priv->is_playback ? PLAYBACK : CAPTURE,
+                               channels, volumes, count, dir);
+
+    if (gam_slider->priv->is_playback)
+        gam_link_fan_out (gam_slider, volumes, count, dir);
+}
@@ -26,6 +26,7 @@
 #include <gtk/gtk.h>
 #include <gtk/gtksizegroup.h>
 #include <alsamixer/gam-mixer.h>
+#include <alsamixer/volume_mapping.h>
 
 #undef ABS
 #define ABS(a)    (((a) < 0) ? -(a) : (a))
@@ -41,6 +42,9 @@ G_BEGIN_DECLS
 #define GAM_IS_SLIDER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GAM_TYPE_SLIDER))
 #define GAM_SLIDER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GAM_TYPE_SLIDER, GamSliderClass))
 
+/* the most channels one gam_slider_post_volume() call writes */
+#define GAM_SLIDER_MAX_WRITE_CHANNELS VOLUME_MAPPING_MAX_CHANNELS
+
 typedef struct _GamSliderPrivate GamSliderPrivate;
 typedef struct _GamSlider GamSlider;
 typedef struct _GamSliderClass GamSliderClass;
@@ -56,7 +60,12 @@ struct _GamSliderClass
 {
     GtkHBoxClass parent_class;
 
-    void (* refresh) (GamSlider *gam_slider);
+    /* the model's volumes of 'channels', a bit per channel, changed */
+    void (* refresh) (GamSlider *gam_slider,
+                      guint      channels);
+
+    /* writes the volume the widgets show; called with the mixer locked */
+    void (* write)   (GamSlider *gam_slider);
 };
     
 GType                 gam_slider_get_type           (void) G_GNUC_CONST;
@@ -72,6 +81,11 @@ gint                  gam_slider_get_toggle_style   (GamSlider   *gam_slider);
 void                  gam_slider_set_toggle_style   (GamSlider   *gam_slider,
                                                      gint         style);
 snd_mixer_elem_t     *gam_slider_get_elem           (GamSlider   *gam_slider);
+const GamElementInfo *gam_slider_get_info          (GamSlider   *gam_slider);
+GamElementModel      *gam_slider_get_model         (GamSlider   *gam_slider);
+enum ctl_dir          gam_slider_get_direction     (GamSlider   *gam_slider);
+GtkAdjustment        *gam_slider_new_volume_adjustment (GamSlider *gam_slider,
+                                                     gdouble      value);
 GtkLabel             *gam_slider_get_label_widget   (GamSlider   *gam_slider);
 GtkWidget            *gam_slider_get_mute_widget    (GamSlider   *gam_slider);
 GtkWidget            *gam_slider_get_capture_widget (GamSlider   *gam_slider);
@@ -80,6 +94,20 @@ void                  gam_slider_add_pan_widget     (GamSlider   *gam_slider,
                                                      GtkWidget   *widget);
 void                  gam_slider_add_volume_widget  (GamSlider   *gam_slider,
                                                      GtkWidget   *widget);
+void                  gam_slider_update             (GamSlider   *gam_slider,
+                                                     guint        channels);
+void                  gam_slider_queue_write        (GamSlider   *gam_slider);
+void                  gam_slider_flush_write        (GamSlider   *gam_slider);
+void                  gam_slider_watch_drag         (GamSlider   *gam_slider,
+                                                     GtkWidget   *range);
+void                  gam_slider_watch_steps        (GamSlider   *gam_slider,
+                                                     GtkWidget   *range);
+void                  gam_slider_post_volume        (GamSlider   *gam_slider,
+                                                     gpointer     slot,
+                                                     const snd_mixer_selem_channel_id_t *channels,
+                                                     const gdouble *volumes,
+                                                     guint        count,
+                                                     gint         dir);
 
 G_END_DECLS
 
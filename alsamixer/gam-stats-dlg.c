@@ -0,0 +1,205 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+/*
+ * A debugging aid: lists the element events of every card, the noisiest
+ * elements first, and how many view updates rate limiting held back.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib/gi18n.h>
+
+#include "gam-stats-dlg.h"
+#include "gam-mixer.h"
+
+enum {
+    COLUMN_CARD,
+    COLUMN_ELEMENT,
+    COLUMN_EVENTS,
+    COLUMN_RATE,
+    COLUMN_THROTTLED,
+    N_COLUMNS
+};
+
+struct _GamStatsDlgPrivate
+{
+    GamApp       *app;
+    GtkListStore *store;
+    guint         timeout_id;
+};
+
+static void     gam_stats_dlg_finalize (GObject     *object);
+static void     gam_stats_dlg_destroy  (GtkWidget   *widget);
+static void     gam_stats_dlg_response (GtkDialog   *dialog,
+                                        gint         response_id);
+static gboolean gam_stats_dlg_update   (gpointer     data);
+
+static gpointer parent_class;
+
+G_DEFINE_TYPE_WITH_CODE (GamStatsDlg, gam_stats_dlg, GTK_TYPE_DIALOG, G_ADD_PRIVATE (GamStatsDlg))
+
+static void
+gam_stats_dlg_class_init (GamStatsDlgClass *klass)
+{
+    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+    GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+    GtkDialogClass *dialog_class = GTK_DIALOG_CLASS (klass);
+
+    parent_class = g_type_class_peek_parent (klass);
+
+    gobject_class->finalize = gam_stats_dlg_finalize;
+
+    widget_class->destroy = gam_stats_dlg_destroy;
+
+    dialog_class->response = gam_stats_dlg_response;
+}
+
+static void
+gam_stats_dlg_add_column (GtkTreeView *view, const gchar *title, gint column)
+{
+    GtkCellRenderer *renderer;
+
+    renderer = gtk_cell_renderer_text_new ();
+    gtk_tree_view_insert_column_with_attributes (view, -1, title, renderer, "text", column, NULL);
+}
+
+static void
+gam_stats_dlg_init (GamStatsDlg *gam_stats_dlg)
+{
+    GtkWidget *scrolled_window, *view;
+
+    gam_stats_dlg->priv = gam_stats_dlg_get_instance_private (gam_stats_dlg);
+
+    gam_stats_dlg->priv->app = NULL;
+    gam_stats_dlg->priv->store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING,
+                                                     G_TYPE_UINT64, G_TYPE_STRING, G_TYPE_UINT64);
+
+    gtk_window_set_title (GTK_WINDOW (gam_stats_dlg), _("Mixer Event Statistics"));
+    gtk_window_set_default_size (GTK_WINDOW (gam_stats_dlg), 480, 320);
+    gtk_dialog_add_button (GTK_DIALOG (gam_stats_dlg), _("_Close"), GTK_RESPONSE_CLOSE);
+
+    scrolled_window = gtk_scrolled_window_new (NULL, NULL);
+    gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scrolled_window), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_box_pack_start (GTK_BOX (gtk_dialog_get_content_area (GTK_DIALOG (gam_stats_dlg))),
+                        scrolled_window, TRUE, TRUE, 0);
+
+    view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (gam_stats_dlg->priv->store));
+    gam_stats_dlg_add_column (GTK_TREE_VIEW (view), _("Card"), COLUMN_CARD);
+    gam_stats_dlg_add_column (GTK_TREE_VIEW (view), _("Element"), COLUMN_ELEMENT);
+    gam_stats_dlg_add_column (GTK_TREE_VIEW (view), _("Events"), COLUMN_EVENTS);
+    gam_stats_dlg_add_column (GTK_TREE_VIEW (view), _("Events/s"), COLUMN_RATE);
+    gam_stats_dlg_add_column (GTK_TREE_VIEW (view), _("Held back"), COLUMN_THROTTLED);
+    gtk_container_add (GTK_CONTAINER (scrolled_window), view);
+
+    gtk_widget_show_all (scrolled_window);
+
+    gam_stats_dlg->priv->timeout_id = g_timeout_add_seconds (1, gam_stats_dlg_update, gam_stats_dlg);
+}
+
+static void
+gam_stats_dlg_finalize (GObject *object)
+{
+    GamStatsDlg *gam_stats_dlg = GAM_STATS_DLG (object);
+
+    g_object_unref (gam_stats_dlg->priv->store);
+
+    gam_stats_dlg->priv->store = NULL;
+
+    G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gam_stats_dlg_destroy (GtkWidget *widget)
+{
+    GamStatsDlg *gam_stats_dlg = GAM_STATS_DLG (widget);
+
+    if (gam_stats_dlg->priv->timeout_id) {
+        g_source_remove (gam_stats_dlg->priv->timeout_id);
+        gam_stats_dlg->priv->timeout_id = 0;
+    }
+
+    gam_stats_dlg->priv->app = NULL;
+
+    GTK_WIDGET_CLASS (parent_class)->destroy (widget);
+}
+
+static void
+gam_stats_dlg_response (GtkDialog *dialog, gint response_id)
+{
+    gtk_widget_destroy (GTK_WIDGET (dialog));
+}
+
+static gboolean
+gam_stats_dlg_update (gpointer data)
+{
+    GamStatsDlg * const gam_stats_dlg = GAM_STATS_DLG (data);
+    GList *mixers, *l;
+
+    gtk_list_store_clear (gam_stats_dlg->priv->store);
+
+    mixers = gam_app_get_mixers (gam_stats_dlg->priv->app);
+    for (l = mixers; l; l = l->next) {
+        GamMixer * const gam_mixer = GAM_MIXER (l->data);
+        GArray *stats;
+        guint i;
+
+        stats = gam_mixer_get_elem_stats (gam_mixer);
+        for (i = 0; i < stats->len; i++) {
+            const GamMixerElemStats * const elem_stats = &g_array_index (stats, GamMixerElemStats, i);
+            gchar *rate;
+
+            rate = g_strdup_printf ("%.1f", elem_stats->rate);
+            gtk_list_store_insert_with_values (gam_stats_dlg->priv->store, NULL, -1,
+                                               COLUMN_CARD, gam_mixer_get_mixer_name (gam_mixer),
+                                               COLUMN_ELEMENT, elem_stats->name,
+                                               COLUMN_EVENTS, elem_stats->events,
+                                               COLUMN_RATE, rate,
+                                               COLUMN_THROTTLED, elem_stats->throttled,
+                                               -1);
+            g_free (rate);
+        }
+        g_array_free (stats, TRUE);
+    }
+    g_list_free (mixers);
+
+    return G_SOURCE_CONTINUE;
+}
+
+GtkWidget *
+gam_stats_dlg_new (GamApp *gam_app)
+{
+    GamStatsDlg *gam_stats_dlg;
+
+    g_return_val_if_fail (GAM_IS_APP (gam_app), NULL);
+
+    gam_stats_dlg = g_object_new (GAM_TYPE_STATS_DLG, NULL);
+    gam_stats_dlg->priv->app = gam_app;
+
+    gtk_window_set_transient_for (GTK_WINDOW (gam_stats_dlg), GTK_WINDOW (gam_app));
+    gtk_window_set_destroy_with_parent (GTK_WINDOW (gam_stats_dlg), TRUE);
+
+    gam_stats_dlg_update (gam_stats_dlg);
+
+    return GTK_WIDGET (gam_stats_dlg);
+}
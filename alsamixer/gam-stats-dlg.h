@@ -0,0 +1,59 @@
+/*
+ *  (gtk-alsamixer) An ALSA mixer for GTK
+ *
+ *  Copyright (C) 2001-2005 Derrick J Houy <djhouy@paw.za.org>.
+ *  Copyright (C) 2022 Sergios - Anestis Kefalidis <sergioskefalidis@gmail.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ */
+
+#ifndef __GAM_STATS_DLG_H__
+#define __GAM_STATS_DLG_H__
+
+#include <gtk/gtk.h>
+
+#include "gam-app.h"
+
+G_BEGIN_DECLS
+
+#define GAM_TYPE_STATS_DLG            (gam_stats_dlg_get_type ())
+#define GAM_STATS_DLG(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GAM_TYPE_STATS_DLG, GamStatsDlg))
+#define GAM_STATS_DLG_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GAM_TYPE_STATS_DLG, GamStatsDlgClass))
+#define GAM_IS_STATS_DLG(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GAM_TYPE_STATS_DLG))
+#define GAM_IS_STATS_DLG_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GAM_TYPE_STATS_DLG))
+#define GAM_STATS_DLG_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GAM_TYPE_STATS_DLG, GamStatsDlgClass))
+
+typedef struct _GamStatsDlgPrivate GamStatsDlgPrivate;
+typedef struct _GamStatsDlg GamStatsDlg;
+typedef struct _GamStatsDlgClass GamStatsDlgClass;
+
+struct _GamStatsDlg
+{
+    GtkDialog parent_instance;
+
+    GamStatsDlgPrivate *priv;
+};
+
+struct _GamStatsDlgClass
+{
+    GtkDialogClass parent_class;
+};
+
+GType      gam_stats_dlg_get_type (void) G_GNUC_CONST;
+GtkWidget *gam_stats_dlg_new      (GamApp *gam_app);
+
+G_END_DECLS
+
+#endif /* __GAM_STATS_DLG_H__ */
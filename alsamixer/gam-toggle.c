@@ -26,6 +26,7 @@
 #include <glib/gi18n.h>
 
 #include "gam-toggle.h"
+#include "gam-element-model.h"
 
 enum {
     PROP_0,
@@ -37,9 +38,12 @@ enum {
 struct _GamTogglePrivate
 {
     snd_mixer_elem_t *elem;
+    const GamElementInfo *info;
+    GamElementModel  *model;
     gpointer          app;
+    /* the toggle is being set to what the model has; nothing is written */
+    gboolean          refreshing;
     gpointer          mixer;
-    gchar            *name_config;
 };
 
 static void     gam_toggle_finalize     (GObject               *object);
@@ -58,8 +62,11 @@ static void     gam_toggle_set_elem     (GamToggle             *gam_slider,
                                          snd_mixer_elem_t      *elem);
 static gint     gam_toggle_toggled_cb   (GtkWidget             *widget,
                                          GamToggle             *gam_toggle);
-static gint     gam_toggle_refresh      (snd_mixer_elem_t      *elem,
+static void     gam_toggle_refresh      (GtkWidget             *widget,
                                          guint                  mask);
+static void     gam_toggle_set_model    (GamToggle             *gam_toggle,
+                                         GamElementModel       *model);
+static void     gam_toggle_destroy      (GtkWidget             *widget);
 
 static gpointer parent_class;
 
@@ -70,6 +77,7 @@ static void
 gam_toggle_class_init (GamToggleClass *klass)
 {
     GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+    GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
     parent_class = g_type_class_peek_parent (klass);
 
@@ -78,6 +86,8 @@ gam_toggle_class_init (GamToggleClass *klass)
     gobject_class->set_property = gam_toggle_set_property;
     gobject_class->get_property = gam_toggle_get_property;
 
+    widget_class->destroy = gam_toggle_destroy;
+
     g_object_class_install_property (gobject_class,
                                      PROP_ELEM,
                                      g_param_spec_pointer ("elem",
@@ -108,8 +118,10 @@ gam_toggle_init (GamToggle *gam_toggle)
     gam_toggle->priv = gam_toggle_get_instance_private (gam_toggle);
 
     gam_toggle->priv->elem = NULL;
-    gam_toggle->priv->name_config = NULL;
+    gam_toggle->priv->info = NULL;
+    gam_toggle->priv->model = NULL;
     gam_toggle->priv->app = NULL;
+    gam_toggle->priv->refreshing = FALSE;
     gam_toggle->priv->mixer = NULL;
 }
 
@@ -122,11 +134,12 @@ gam_toggle_finalize (GObject *object)
 
     gam_toggle = GAM_TOGGLE (object);
 
-    snd_mixer_elem_set_callback (gam_toggle->priv->elem, NULL);
+    if (gam_toggle->priv->mixer && gam_toggle->priv->elem)
+        gam_mixer_unsubscribe (GAM_MIXER (gam_toggle->priv->mixer), gam_toggle->priv->elem, GTK_WIDGET (gam_toggle));
 
-    g_free (gam_toggle->priv->name_config);
+    gam_toggle_set_model (gam_toggle, NULL);
 
-    gam_toggle->priv->name_config = NULL;
+    gam_toggle->priv->info = NULL;
     gam_toggle->priv->elem = NULL;
     gam_toggle->priv->mixer = NULL;
     gam_toggle->priv->app = NULL;
@@ -148,6 +161,12 @@ gam_toggle_constructor (GType                  type,
 
     gam_toggle = GAM_TOGGLE (object);
 
+    gam_mixer_subscribe (GAM_MIXER (gam_toggle->priv->mixer), gam_toggle->priv->elem,
+                         GTK_WIDGET (gam_toggle), gam_toggle_refresh);
+    gam_toggle_set_model (gam_toggle, gam_mixer_get_model (GAM_MIXER (gam_toggle->priv->mixer),
+                                                           gam_toggle->priv->elem));
+    gam_toggle->priv->info = gam_mixer_get_elem_info (GAM_MIXER (gam_toggle->priv->mixer), gam_toggle->priv->elem);
+
     gtk_button_set_label (GTK_BUTTON (gam_toggle), gam_toggle_get_name (gam_toggle));
 
     gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (gam_toggle),
@@ -216,21 +235,73 @@ gam_toggle_get_property (GObject    *object,
 static gint
 gam_toggle_toggled_cb (GtkWidget *widget, GamToggle *gam_toggle)
 {
+    if (gam_toggle->priv->refreshing)
+        return TRUE;
+
     gam_toggle_set_state (gam_toggle, 
         gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (widget)));
 
     return TRUE;
 }
 
-static gint
-gam_toggle_refresh (snd_mixer_elem_t *elem, guint mask)
+static void
+gam_toggle_destroy (GtkWidget *widget)
 {
-    GamToggle * const gam_toggle = GAM_TOGGLE (snd_mixer_elem_get_callback_private (elem));
+    GamToggle * const gam_toggle = GAM_TOGGLE (widget);
+
+    if (gam_toggle->priv->mixer)
+        gam_mixer_cancel_writes (GAM_MIXER (gam_toggle->priv->mixer), widget);
+
+    /* the model may outlive us in the other views of the element */
+    if (gam_toggle->priv->model)
+        g_signal_handlers_disconnect_by_data (gam_toggle->priv->model, gam_toggle);
+
+    GTK_WIDGET_CLASS (parent_class)->destroy (widget);
+}
+
+static void
+gam_toggle_refresh (GtkWidget *widget, guint mask)
+{
+    /* the element is about to be freed; the state comes from the model */
+    if (mask == SND_CTL_EVENT_MASK_REMOVE)
+        gtk_widget_hide (widget);
+}
+
+/* the toggle shows the first channel */
+static void
+gam_toggle_switch_changed_cb (GamElementModel *model, gint dir, guint channels, GamToggle *gam_toggle)
+{
+    if (channels & 1u)
+        gam_toggle_update (gam_toggle);
+}
+
+static void
+gam_toggle_set_model (GamToggle *gam_toggle, GamElementModel *model)
+{
+    if (gam_toggle->priv->model) {
+        g_signal_handlers_disconnect_by_data (gam_toggle->priv->model, gam_toggle);
+        g_clear_object (&gam_toggle->priv->model);
+    }
+
+    if (model == NULL)
+        return;
+
+    gam_toggle->priv->model = g_object_ref (model);
+
+    g_signal_connect (G_OBJECT (model), "switch_changed",
+                      G_CALLBACK (gam_toggle_switch_changed_cb), gam_toggle);
+}
 
+void
+gam_toggle_update (GamToggle *gam_toggle)
+{
+    g_return_if_fail (GAM_IS_TOGGLE (gam_toggle));
+
+    /* showing the hardware state must not write it back over a pending click */
+    gam_toggle->priv->refreshing = TRUE;
     gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (gam_toggle),
                                   gam_toggle_get_state (gam_toggle));
-
-    return 0;
+    gam_toggle->priv->refreshing = FALSE;
 }
 
 GtkWidget *
@@ -251,12 +322,14 @@ gam_toggle_set_elem (GamToggle *gam_toggle, snd_mixer_elem_t *elem)
 {
     g_return_if_fail (GAM_IS_TOGGLE (gam_toggle));
 
-    if (gam_toggle->priv->elem)
-        snd_mixer_elem_set_callback (gam_toggle->priv->elem, NULL);
+    /* before construction the mixer may not be known yet; the constructor subscribes then */
+    if (gam_toggle->priv->mixer && gam_toggle->priv->elem)
+        gam_mixer_unsubscribe (GAM_MIXER (gam_toggle->priv->mixer), gam_toggle->priv->elem, GTK_WIDGET (gam_toggle));
 
-    if (elem) {
-        snd_mixer_elem_set_callback_private (elem, gam_toggle);
-        snd_mixer_elem_set_callback (elem, gam_toggle_refresh);
+    if (gam_toggle->priv->mixer && elem) {
+        gam_mixer_subscribe (GAM_MIXER (gam_toggle->priv->mixer), elem, GTK_WIDGET (gam_toggle), gam_toggle_refresh);
+        gam_toggle_set_model (gam_toggle, gam_mixer_get_model (GAM_MIXER (gam_toggle->priv->mixer), elem));
+        gam_toggle->priv->info = gam_mixer_get_elem_info (GAM_MIXER (gam_toggle->priv->mixer), elem);
     }
 
     gam_toggle->priv->elem = elem;
@@ -267,41 +340,60 @@ gam_toggle_set_elem (GamToggle *gam_toggle, snd_mixer_elem_t *elem)
 gboolean
 gam_toggle_get_state (GamToggle *gam_toggle)
 {
-    gint value = 0;
+    gboolean value = FALSE;
 
-    if (snd_mixer_selem_has_playback_switch (gam_toggle->priv->elem)) {
-        snd_mixer_selem_get_playback_switch (gam_toggle->priv->elem, 0, &value);
-    } else if (snd_mixer_selem_has_capture_switch (gam_toggle->priv->elem)) {
-        snd_mixer_selem_get_capture_switch (gam_toggle->priv->elem, 0, &value);
+    if (gam_toggle->priv->info->has_switch[PLAYBACK]) {
+        value = gam_element_model_get_switch (gam_toggle->priv->model, PLAYBACK, 0);
+    } else if (gam_toggle->priv->info->has_switch[CAPTURE]) {
+        value = gam_element_model_get_switch (gam_toggle->priv->model, CAPTURE, 0);
     } else {
         g_warning ("%s (). No idea what to do for mixer element \"%s\"!",
-                   __FUNCTION__, snd_mixer_selem_get_name (gam_toggle->priv->elem));
+                   __FUNCTION__, gam_toggle_get_name (gam_toggle));
     }
 
     return value;
 }
 
-void
-gam_toggle_set_state (GamToggle *gam_toggle, gboolean state)
+static gint
+gam_toggle_write_state (snd_mixer_elem_t *elem, gpointer data)
 {
-    const gboolean internal_state = gam_toggle_get_state (gam_toggle);
-    int err;
+    if (snd_mixer_selem_has_playback_switch (elem))
+        return snd_mixer_selem_set_playback_switch_all (elem, GPOINTER_TO_INT (data));
+    else if (snd_mixer_selem_has_capture_switch (elem))
+        return snd_mixer_selem_set_capture_switch_all (elem, GPOINTER_TO_INT (data));
 
-    if (state == internal_state) return;
+    return 0;
+}
 
-    if (snd_mixer_selem_has_playback_switch (gam_toggle->priv->elem)) {
-        err = snd_mixer_selem_set_playback_switch_all (gam_toggle->priv->elem, state);
-    } else if (snd_mixer_selem_has_capture_switch (gam_toggle->priv->elem)) {
-        err = snd_mixer_selem_set_capture_switch_all (gam_toggle->priv->elem, state);
-    } else {
+/* the toggle goes back to the real state of the switch */
+static void
+gam_toggle_write_failed (GtkWidget *view, gint err)
+{
+    GamToggle * const gam_toggle = GAM_TOGGLE (view);
+
+    g_warning ("%s: %s", gam_toggle_get_name (gam_toggle), snd_strerror (err));
+
+    gam_toggle_update (gam_toggle);
+}
+
+/*
+ * The switch is written by the writer thread; ALSA skips the write when the
+ * switch already is in that state.  A click that undoes one still on its way
+ * is posted too, as it replaces it.
+ */
+void
+gam_toggle_set_state (GamToggle *gam_toggle, gboolean state)
+{
+    if (!gam_toggle->priv->info->has_switch[PLAYBACK] &&
+        !gam_toggle->priv->info->has_switch[CAPTURE]) {
         g_warning ("%s (). No idea what to do for mixer element \"%s\"!",
-                   __FUNCTION__, snd_mixer_selem_get_name (gam_toggle->priv->elem));
-        err = 0;
+                   __FUNCTION__, gam_toggle_get_name (gam_toggle));
+        return;
     }
 
-    if (err)
-        gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (gam_toggle),
-                                      internal_state);
+    gam_mixer_post_write (GAM_MIXER (gam_toggle->priv->mixer), gam_toggle->priv->elem,
+                          GTK_WIDGET (gam_toggle), gam_toggle, gam_toggle_write_state,
+                          GINT_TO_POINTER (state), NULL, gam_toggle_write_failed);
 }
 
 const gchar *
@@ -309,7 +401,7 @@ gam_toggle_get_name (GamToggle *gam_toggle)
 {
     g_return_val_if_fail (GAM_IS_TOGGLE (gam_toggle), NULL);
 
-    return snd_mixer_selem_get_name (gam_toggle->priv->elem);
+    return g_quark_to_string (gam_toggle->priv->info->name);
 }
 
 const gchar *
@@ -317,12 +409,7 @@ gam_toggle_get_config_name (GamToggle *gam_toggle)
 {
     g_return_val_if_fail (GAM_IS_TOGGLE (gam_toggle), NULL);
 
-//    if (gam_toggle->priv->name_config == NULL) {
-        gam_toggle->priv->name_config = g_strdup (gam_toggle_get_name (gam_toggle));
-        gam_toggle->priv->name_config = g_strdelimit (gam_toggle->priv->name_config, GAM_CONFIG_DELIMITERS, '_');
-//    }
-
-    return gam_toggle->priv->name_config;
+    return g_quark_to_string (gam_toggle->priv->info->config_name);
 }
 
 gchar *
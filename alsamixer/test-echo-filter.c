@@ -0,0 +1,96 @@
+/*
+ * Checks of the filter that drops the echoes of our own writes; run by
+ * "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gam-echo-filter.h"
+
+static int failures;
+
+#define CHECK(cond, ...)				\
+	do {						\
+		if (!(cond)) {				\
+			fprintf(stderr, __VA_ARGS__);	\
+			fputc('\n', stderr);		\
+			failures++;			\
+		}					\
+	} while (0)
+
+static void check_unarmed(void)
+{
+	GamEchoFilter filter;
+	GamEchoState state;
+
+	memset(&state, 0, sizeof(state));
+	gam_echo_filter_init(&filter);
+	CHECK(!gam_echo_filter_check(&filter, &state),
+	      "unarmed: an event was taken for an echo");
+}
+
+static void check_mono(void)
+{
+	GamEchoFilter filter;
+	GamEchoState state;
+
+	memset(&state, 0, sizeof(state));
+	state.volume[0][0] = 12;
+	gam_echo_filter_init(&filter);
+	gam_echo_filter_arm(&filter, &state);
+	CHECK(gam_echo_filter_check(&filter, &state),
+	      "mono: the echo of a write reached the views");
+}
+
+/* A write of two channels, one by one, brings one event per channel. */
+static void check_stereo(void)
+{
+	GamEchoFilter filter;
+	GamEchoState written, outside;
+
+	memset(&written, 0, sizeof(written));
+	written.volume[0][0] = 20;
+	written.volume[0][1] = 22;
+	gam_echo_filter_init(&filter);
+	gam_echo_filter_arm(&filter, &written);
+	CHECK(gam_echo_filter_check(&filter, &written),
+	      "stereo: the first channel's echo reached the views");
+	CHECK(gam_echo_filter_check(&filter, &written),
+	      "stereo: the second channel's echo reached the views");
+
+	outside = written;
+	outside.volume[0][1] = 5;
+	CHECK(!gam_echo_filter_check(&filter, &outside),
+	      "stereo: an outside change was taken for an echo");
+	CHECK(!gam_echo_filter_check(&filter, &written),
+	      "stereo: an outside change back to the written state was dropped");
+}
+
+static void check_switch(void)
+{
+	GamEchoFilter filter;
+	GamEchoState written, outside;
+
+	memset(&written, 0, sizeof(written));
+	written.switches[0][0] = 1;
+	gam_echo_filter_init(&filter);
+	gam_echo_filter_arm(&filter, &written);
+
+	outside = written;
+	outside.switches[1][0] = 1;
+	CHECK(!gam_echo_filter_check(&filter, &outside),
+	      "switch: a capture switch change was taken for an echo");
+}
+
+int main(void)
+{
+	check_unarmed();
+	check_mono();
+	check_stereo();
+	check_switch();
+
+	if (failures)
+		fprintf(stderr, "%d check(s) failed\n", failures);
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,286 @@
+/*
+ * Checks of the volume mapping kernel; run by "make check".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "volume_mapping_kernel.h"
+
+struct test_range {
+	const char *name;
+	enum volume_mapping_curve curve;
+	bool have_dB;
+	long dB_min, dB_max;
+	long raw_min, raw_max;
+	long check_min;		/* lowest value checked for round trips */
+};
+
+static const struct test_range ranges[] = {
+	{ "linear dB", VOLUME_MAPPING_CURVE_AUTO, true, -2400, 0, 0, 31, -2400 },
+	{ "linear dB, forced", VOLUME_MAPPING_CURVE_LINEAR_DB, true, -6350, 0, 0, 127, -6350 },
+	{ "cubic", VOLUME_MAPPING_CURVE_AUTO, true, -6350, 600, 0, 255, -6350 },
+	/*
+	 * Positions close to a mute minimum underflow to 0, so only the
+	 * audible part of the range can round-trip.
+	 */
+	{ "cubic, mute", VOLUME_MAPPING_CURVE_AUTO, true,
+	  VOLUME_MAPPING_DB_GAIN_MUTE, 0, 0, 255, -9000 },
+	{ "raw", VOLUME_MAPPING_CURVE_AUTO, false, 0, 0, 0, 65536, 0 },
+	{ "raw, forced", VOLUME_MAPPING_CURVE_RAW, true, -6350, 0, -10, 87, -10 },
+};
+
+static int failures;
+
+#define CHECK(cond, ...)				\
+	do {						\
+		if (!(cond)) {				\
+			fprintf(stderr, __VA_ARGS__);	\
+			fputc('\n', stderr);		\
+			failures++;			\
+		}					\
+	} while (0)
+
+static void check_round_trip(const struct test_range *t,
+			     const struct volume_range *range)
+{
+	long value, low;
+	int dir;
+
+	low = t->check_min > range->min ? t->check_min : range->min;
+
+	for (dir = -1; dir <= 1; dir++) {
+		CHECK(volume_range_from_normalized(range, 0, dir) == range->min,
+		      "%s: 0 does not map to the minimum (dir %d)", t->name, dir);
+		CHECK(volume_range_from_normalized(range, 1, dir) == range->max,
+		      "%s: 1 does not map to the maximum (dir %d)", t->name, dir);
+
+		for (value = low; value <= range->max; value++) {
+			double volume = volume_range_to_normalized(range, value);
+			long back = volume_range_from_normalized(range, volume, dir);
+
+			if (back != value) {
+				CHECK(0, "%s: %ld -> %.12f -> %ld (dir %d)",
+				      t->name, value, volume, back, dir);
+				break;
+			}
+		}
+	}
+}
+
+/* a position between two values must round towards 'dir' */
+static void check_direction(const struct test_range *t,
+			    const struct volume_range *range)
+{
+	long value, low;
+
+	low = t->check_min > range->min ? t->check_min : range->min;
+
+	for (value = low; value < range->max; value++) {
+		double a = volume_range_to_normalized(range, value);
+		double b = volume_range_to_normalized(range, value + 1);
+		double mid = (a + b) / 2;
+		long up = volume_range_from_normalized(range, mid, 1);
+		long down = volume_range_from_normalized(range, mid, -1);
+
+		if (up != value + 1 || down != value) {
+			CHECK(0, "%s: between %ld and %ld rounds to %ld/%ld",
+			      t->name, value, value + 1, down, up);
+			break;
+		}
+	}
+}
+
+/* the array conversions must agree with the scalar ones */
+static void check_bulk(const struct test_range *t,
+		       const struct volume_range *range)
+{
+	enum { COUNT = 1001 };
+	double volumes[COUNT], normalized[COUNT];
+	long values[COUNT], converted[COUNT];
+	unsigned int i;
+	int dir;
+
+	for (i = 0; i < COUNT; i++) {
+		volumes[i] = (double)i / (COUNT - 1);
+		values[i] = range->min + (range->max - range->min) * (long)i / (COUNT - 1);
+	}
+	volumes[0] = -0.5;
+	volumes[COUNT - 1] = 1.5;
+
+	volume_range_to_normalized_n(range, values, normalized, COUNT);
+	for (i = 0; i < COUNT; i++) {
+		if (normalized[i] != volume_range_to_normalized(range, values[i])) {
+			CHECK(0, "%s: bulk read of %ld differs", t->name, values[i]);
+			break;
+		}
+	}
+
+	for (dir = -1; dir <= 1; dir++) {
+		volume_range_from_normalized_n(range, volumes, converted, COUNT, dir);
+		for (i = 0; i < COUNT; i++) {
+			if (converted[i] != volume_range_from_normalized(range, volumes[i], dir)) {
+				CHECK(0, "%s: bulk write of %f differs (dir %d)",
+				      t->name, volumes[i], dir);
+				break;
+			}
+		}
+	}
+}
+
+static void check_table(const struct test_range *t,
+			const struct volume_range *range)
+{
+	long steps = t->raw_max - t->raw_min + 1;
+	long i, *values;
+	double *table;
+	int dir;
+
+	if (range->scale == VOLUME_MAPPING_RAW || steps > 4096)
+		return;
+
+	values = malloc(steps * sizeof(*values));
+	table = malloc(steps * sizeof(*table));
+	if (!values || !table)
+		abort();
+
+	/*
+	 * dB values spread evenly over the range, like a dB_SCALE TLV; with a
+	 * mute minimum, only the first step is mute.
+	 */
+	if (range->min == VOLUME_MAPPING_DB_GAIN_MUTE) {
+		values[0] = range->min;
+		for (i = 1; i < steps; i++)
+			values[i] = t->check_min + (range->max - t->check_min) * (i - 1) / (steps - 2);
+	} else {
+		for (i = 0; i < steps; i++)
+			values[i] = range->min + (range->max - range->min) * i / (steps - 1);
+	}
+	volume_table_fill(range, values, steps, table);
+
+	for (i = 1; i < steps; i++)
+		CHECK(table[i] >= table[i - 1], "%s: table not sorted at %ld",
+		      t->name, i);
+
+	for (dir = -1; dir <= 1; dir++) {
+		for (i = 0; i < steps; i++) {
+			long found = volume_table_lookup(table, steps, table[i], dir);
+
+			if (table[found] != table[i]) {
+				CHECK(0, "%s: table entry %ld found as %ld (dir %d)",
+				      t->name, i, found, dir);
+				break;
+			}
+		}
+		CHECK(volume_table_lookup(table, steps, 0, dir) == 0,
+		      "%s: 0 not at the start of the table (dir %d)", t->name, dir);
+		CHECK(volume_table_lookup(table, steps, 1, dir) == steps - 1,
+		      "%s: 1 not at the end of the table (dir %d)", t->name, dir);
+	}
+
+	for (dir = -1; dir <= 1; dir++) {
+		long *indexes = malloc(steps * sizeof(*indexes));
+
+		if (!indexes)
+			abort();
+		volume_table_lookup_n(table, steps, table, indexes, steps, dir);
+		for (i = 0; i < steps; i++) {
+			if (indexes[i] != volume_table_lookup(table, steps, table[i], dir)) {
+				CHECK(0, "%s: bulk table lookup of %ld differs (dir %d)",
+				      t->name, i, dir);
+				break;
+			}
+		}
+		free(indexes);
+	}
+
+	for (i = 0; i + 1 < steps; i++) {
+		double mid = (table[i] + table[i + 1]) / 2;
+
+		if (table[i] == table[i + 1])
+			continue;
+		if (volume_table_lookup(table, steps, mid, 1) != i + 1 ||
+		    volume_table_lookup(table, steps, mid, -1) != i) {
+			CHECK(0, "%s: table position between %ld and %ld rounds wrongly",
+			      t->name, i, i + 1);
+			break;
+		}
+	}
+
+	/* a step from any entry reaches the next position, skipping none */
+	for (i = 0; i < steps; i++) {
+		long up = volume_table_step(table, steps, table[i], 1);
+		long down = volume_table_step(table, steps, table[i], -1);
+		long next = i, prev = i;
+
+		while (next < steps - 1 && table[next] == table[i])
+			next++;
+		while (prev > 0 && table[prev] == table[i])
+			prev--;
+		if (table[up] != table[next] || table[down] != table[prev]) {
+			CHECK(0, "%s: step from table entry %ld reaches %ld/%ld instead of %ld/%ld",
+			      t->name, i, down, up, prev, next);
+			break;
+		}
+	}
+
+	free(values);
+	free(table);
+}
+
+static void check_fades(void)
+{
+	static const enum volume_fade_curve curves[] = {
+		VOLUME_FADE_LINEAR, VOLUME_FADE_SMOOTH,
+		VOLUME_FADE_EASE_IN, VOLUME_FADE_EASE_OUT,
+	};
+	unsigned int i, step;
+
+	for (i = 0; i < sizeof(curves) / sizeof(curves[0]); i++) {
+		double previous = 0.8;
+
+		CHECK(volume_fade_position(curves[i], 0.8, 0.2, -1) == 0.8,
+		      "fade %u: does not start at its start", i);
+		CHECK(volume_fade_position(curves[i], 0.8, 0.2, 2) == 0.2,
+		      "fade %u: does not end at its end", i);
+
+		for (step = 0; step <= 100; step++) {
+			double volume = volume_fade_position(curves[i], 0.8, 0.2, step / 100.0);
+
+			if (volume > previous || volume < 0.2) {
+				CHECK(0, "fade %u: leaves its range or turns back at %u%%", i, step);
+				break;
+			}
+			previous = volume;
+		}
+	}
+
+	CHECK(volume_fade_position(VOLUME_FADE_SMOOTH, 0, 1, 0.5) == 0.5,
+	      "smooth fade: not halfway at half time");
+	CHECK(volume_fade_position(VOLUME_FADE_EASE_IN, 0, 1, 0.5) < 0.5,
+	      "ease-in fade: not slow at the start");
+	CHECK(volume_fade_position(VOLUME_FADE_EASE_OUT, 0, 1, 0.5) > 0.5,
+	      "ease-out fade: not slow at the end");
+}
+
+int main(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+		const struct test_range *t = &ranges[i];
+		struct volume_range range;
+
+		volume_range_init(&range, t->curve, t->have_dB, t->dB_min, t->dB_max,
+				  t->raw_min, t->raw_max);
+		check_round_trip(t, &range);
+		check_direction(t, &range);
+		check_bulk(t, &range);
+		check_table(t, &range);
+	}
+
+	check_fades();
+
+	if (failures)
+		fprintf(stderr, "%d check(s) failed\n", failures);
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -26,32 +26,38 @@
  * information, a linear mapping of the hardware volume register values is used
  * (this is the same algorithm as used in the old alsamixer).
  *
+ * The math itself lives in volume_mapping_kernel.c; this file adds the ALSA
+ * calls around it.
+ *
  * When setting the volume, 'dir' is the rounding direction:
  * -1/0/1 = down/nearest/up.
+ *
+ * A struct volume_mapping caches the ranges and the chosen scale of one
+ * element direction, so that reading or writing a channel does not have to
+ * query the ranges again.  It must be invalidated when ALSA reports
+ * SND_CTL_EVENT_MASK_INFO for the element; it is reloaded on the next use.
+ *
+ * For dB-based scales the descriptor also holds a table with the normalized
+ * position of every hardware step (up to MAX_TABLE_STEPS), so reading a
+ * channel is a lookup and writing one is a binary search instead of calls
+ * to pow() and log10().  The curve can be forced to cubic, linear dB or raw
+ * register values; the default picks cubic or linear dB as described above.
+ * volume_mapping_quantize() returns the position of the hardware step that a
+ * value would be written as, so that a slider can show exactly what the
+ * element holds; volume_mapping_step() the position of the step next to it.
+ *
+ * The _n functions read or write several channels of an element at once,
+ * converting all values in one pass; when a write gives every channel of the
+ * element the same value, it goes through a single set_*_all call.  The
+ * _bulk functions do the same for an array of elements.
  */
 
-#include <math.h>
+#include <errno.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include "volume_mapping.h"
 
-#define MAX_LINEAR_DB_SCALE	24
-
-static inline bool use_linear_dB_scale(long dBmin, long dBmax)
-{
-	return dBmax - dBmin <= MAX_LINEAR_DB_SCALE * 100;
-}
-
-static long lrint_dir(double x, int dir)
-{
-	if (dir > 0)
-		return lrint(ceil(x));
-	else if (dir < 0)
-		return lrint(floor(x));
-	else
-		return lrint(x);
-}
-
-enum ctl_dir { PLAYBACK, CAPTURE };
+#define MAX_TABLE_STEPS		8192
 
 static int (* const get_dB_range[2])(snd_mixer_elem_t *, long *, long *) = {
 	snd_mixer_selem_get_playback_dB_range,
@@ -73,105 +79,501 @@ static int (* const set_dB[2])(snd_mixer_elem_t *, snd_mixer_selem_channel_id_t,
 	snd_mixer_selem_set_playback_dB,
 	snd_mixer_selem_set_capture_dB,
 };
+static int (* const ask_vol_dB[2])(snd_mixer_elem_t *, long, long *) = {
+	snd_mixer_selem_ask_playback_vol_dB,
+	snd_mixer_selem_ask_capture_vol_dB,
+};
 static int (* const set_raw[2])(snd_mixer_elem_t *, snd_mixer_selem_channel_id_t, long) = {
 	snd_mixer_selem_set_playback_volume,
 	snd_mixer_selem_set_capture_volume,
 };
+static int (* const set_dB_all[2])(snd_mixer_elem_t *, long, int) = {
+	snd_mixer_selem_set_playback_dB_all,
+	snd_mixer_selem_set_capture_dB_all,
+};
+static int (* const set_raw_all[2])(snd_mixer_elem_t *, long) = {
+	snd_mixer_selem_set_playback_volume_all,
+	snd_mixer_selem_set_capture_volume_all,
+};
+static int (* const has_channel[2])(snd_mixer_elem_t *, snd_mixer_selem_channel_id_t) = {
+	snd_mixer_selem_has_playback_channel,
+	snd_mixer_selem_has_capture_channel,
+};
+
+#define MAX_CHANNELS		VOLUME_MAPPING_MAX_CHANNELS
+
+struct volume_mapping {
+	snd_mixer_elem_t *elem;
+	enum ctl_dir ctl_dir;
+	enum volume_mapping_curve curve;
+	bool valid;
+	int err;
+	struct volume_range range;
+	long raw_min, raw_max;
+	long steps;		/* number of entries in table, 0 if none */
+	double *table;		/* normalized position of each raw step */
+	unsigned int channels;	/* bit mask of the element's channels */
+};
 
-static double get_normalized_volume(snd_mixer_elem_t *elem,
-				    snd_mixer_selem_channel_id_t channel,
-				    enum ctl_dir ctl_dir)
+static int query_range(snd_mixer_elem_t *elem, enum ctl_dir ctl_dir,
+		       enum volume_mapping_curve curve,
+		       struct volume_range *range,
+		       long *raw_min, long *raw_max)
 {
-	long min, max, value;
-	double normalized, min_norm;
+	long dB_min = 0, dB_max = 0;
+	int err, raw_err;
+
+	*raw_min = *raw_max = 0;
+	raw_err = get_raw_range[ctl_dir](elem, raw_min, raw_max);
+	err = get_dB_range[ctl_dir](elem, &dB_min, &dB_max);
+
+	volume_range_init(range, curve, err >= 0, dB_min, dB_max, *raw_min, *raw_max);
+
+	if (range->scale == VOLUME_MAPPING_RAW)
+		return raw_err < 0 ? raw_err : 0;
+	return raw_err < 0 ? 1 : 0;	/* usable, but no raw range */
+}
+
+static void volume_mapping_build_table(struct volume_mapping *map)
+{
+	long steps = map->raw_max - map->raw_min + 1;
+	long i, *values;
+	double *table;
+
+	values = malloc(steps * sizeof(*values));
+	table = malloc(steps * sizeof(*table));
+	if (!values || !table)
+		goto out;
+
+	for (i = 0; i < steps; i++)
+		if (ask_vol_dB[map->ctl_dir](map->elem, map->raw_min + i, &values[i]) < 0)
+			goto out;
+
+	volume_table_fill(&map->range, values, steps, table);
+	map->table = table;
+	map->steps = steps;
+	table = NULL;
+out:
+	free(values);
+	free(table);
+}
+
+/*
+ * Writing the raw value the element already has would only produce an event
+ * that echoes back into the sliders, so such writes are skipped.
+ */
+static int set_raw_changed(const struct volume_mapping *map,
+			   snd_mixer_selem_channel_id_t channel,
+			   long value)
+{
+	long current;
+
+	if (get_raw[map->ctl_dir](map->elem, channel, &current) >= 0 &&
+	    current == value)
+		return 0;
+
+	return set_raw[map->ctl_dir](map->elem, channel, value);
+}
+
+static void volume_mapping_load(struct volume_mapping *map)
+{
+	snd_mixer_selem_channel_id_t channel;
 	int err;
 
-	err = get_dB_range[ctl_dir](elem, &min, &max);
-	if (err < 0 || min >= max) {
-		err = get_raw_range[ctl_dir](elem, &min, &max);
-		if (err < 0 || min == max)
-			return 0;
+	free(map->table);
+	map->table = NULL;
+	map->steps = 0;
+
+	err = query_range(map->elem, map->ctl_dir, map->curve, &map->range,
+			  &map->raw_min, &map->raw_max);
+	map->err = err < 0 ? err : 0;
+	map->valid = true;
+
+	map->channels = 0;
+	for (channel = 0; channel < MAX_CHANNELS; channel++)
+		if (has_channel[map->ctl_dir](map->elem, channel))
+			map->channels |= 1u << channel;
+
+	if (err == 0 && map->range.scale != VOLUME_MAPPING_RAW &&
+	    map->raw_max > map->raw_min && map->raw_max - map->raw_min < MAX_TABLE_STEPS)
+		volume_mapping_build_table(map);
+}
+
+static inline struct volume_mapping *volume_mapping_get(struct volume_mapping *map)
+{
+	if (!map->valid)
+		volume_mapping_load(map);
+	return map;
+}
+
+struct volume_mapping *volume_mapping_new(snd_mixer_elem_t *elem,
+					  enum ctl_dir ctl_dir,
+					  enum volume_mapping_curve curve)
+{
+	struct volume_mapping *map;
+
+	map = calloc(1, sizeof(*map));
+	if (!map)
+		return NULL;
+
+	map->elem = elem;
+	map->ctl_dir = ctl_dir;
+	map->curve = curve;
+	volume_mapping_load(map);
+
+	return map;
+}
+
+void volume_mapping_free(struct volume_mapping *map)
+{
+	if (!map)
+		return;
+
+	free(map->table);
+	free(map);
+}
 
-		err = get_raw[ctl_dir](elem, channel, &value);
+void volume_mapping_invalidate(struct volume_mapping *map)
+{
+	map->valid = false;
+}
+
+long volume_mapping_get_steps(struct volume_mapping *map)
+{
+	map = volume_mapping_get(map);
+	if (map->err < 0)
+		return 0;
+
+	if (map->table)
+		return map->steps;
+	if (map->range.scale == VOLUME_MAPPING_RAW)
+		return map->range.max - map->range.min + 1;
+	return 0;
+}
+
+/*
+ * Fills 'channels', which has room for VOLUME_MAPPING_MAX_CHANNELS entries,
+ * with the channels the element has, in ALSA order; returns their number.
+ */
+unsigned int volume_mapping_get_channels(struct volume_mapping *map,
+					 snd_mixer_selem_channel_id_t *channels)
+{
+	unsigned int count = 0;
+	int channel;
+
+	map = volume_mapping_get(map);
+	for (channel = 0; channel < MAX_CHANNELS; channel++)
+		if (map->channels & (1u << channel))
+			channels[count++] = channel;
+
+	return count;
+}
+
+double volume_mapping_quantize(struct volume_mapping *map,
+			       double volume,
+			       int dir)
+{
+	map = volume_mapping_get(map);
+	if (map->err < 0)
+		return volume;
+
+	if (volume < 0)
+		volume = 0;
+	else if (volume > 1)
+		volume = 1;
+
+	if (map->table)
+		return map->table[volume_table_lookup(map->table, map->steps, volume, dir)];
+	if (map->range.scale == VOLUME_MAPPING_RAW)
+		return volume_range_to_normalized(&map->range,
+			volume_range_from_normalized(&map->range, volume, dir));
+	return volume;
+}
+
+/*
+ * The position of the hardware step next to 'volume' in direction 'dir'
+ * (-1/1), however far the scale puts it; one percent further when the steps
+ * are not known.
+ */
+double volume_mapping_step(struct volume_mapping *map,
+			   double volume,
+			   int dir)
+{
+	long value;
+
+	map = volume_mapping_get(map);
+	if (map->err >= 0 && map->table)
+		return map->table[volume_table_step(map->table, map->steps, volume, dir)];
+
+	if (map->err >= 0 && map->range.scale == VOLUME_MAPPING_RAW) {
+		value = volume_range_from_normalized(&map->range, volume, 0) + (dir > 0 ? 1 : -1);
+		if (value < map->range.min)
+			value = map->range.min;
+		else if (value > map->range.max)
+			value = map->range.max;
+		return volume_range_to_normalized(&map->range, value);
+	}
+
+	volume += dir > 0 ? 0.01 : -0.01;
+	return volume < 0 ? 0 : volume > 1 ? 1 : volume;
+}
+
+/*
+ * The gain, in 1/100 dB, that a normalized volume is written as; fails if
+ * the element does not know its gains.
+ */
+int volume_mapping_to_dB(struct volume_mapping *map,
+			 double volume,
+			 int dir,
+			 long *dB)
+{
+	long value;
+
+	map = volume_mapping_get(map);
+	if (map->err < 0)
+		return map->err;
+
+	if (map->table) {
+		value = volume_table_lookup(map->table, map->steps, volume, dir) + map->raw_min;
+		return ask_vol_dB[map->ctl_dir](map->elem, value, dB);
+	}
+
+	value = volume_range_from_normalized(&map->range, volume, dir);
+	if (map->range.scale == VOLUME_MAPPING_RAW)
+		return ask_vol_dB[map->ctl_dir](map->elem, value, dB);
+
+	*dB = value;
+	return 0;
+}
+
+enum volume_mapping_scale volume_mapping_get_scale(struct volume_mapping *map)
+{
+	return volume_mapping_get(map)->range.scale;
+}
+
+double volume_mapping_get_normalized(struct volume_mapping *map,
+				     snd_mixer_selem_channel_id_t channel)
+{
+	long value;
+	int err;
+
+	map = volume_mapping_get(map);
+	if (map->err < 0)
+		return 0;
+
+	if (map->table) {
+		err = get_raw[map->ctl_dir](map->elem, channel, &value);
 		if (err < 0)
 			return 0;
 
-		return (value - min) / (double)(max - min);
+		value -= map->raw_min;
+		if (value < 0)
+			value = 0;
+		else if (value >= map->steps)
+			value = map->steps - 1;
+		return map->table[value];
 	}
 
-	err = get_dB[ctl_dir](elem, channel, &value);
+	if (map->range.scale == VOLUME_MAPPING_RAW)
+		err = get_raw[map->ctl_dir](map->elem, channel, &value);
+	else
+		err = get_dB[map->ctl_dir](map->elem, channel, &value);
 	if (err < 0)
 		return 0;
 
-	if (use_linear_dB_scale(min, max))
-		return (value - min) / (double)(max - min);
+	return volume_range_to_normalized(&map->range, value);
+}
 
-	normalized = pow(10, (value - max) / 6000.0);
-	if (min != SND_CTL_TLV_DB_GAIN_MUTE) {
-		min_norm = pow(10, (min - max) / 6000.0);
-		normalized = (normalized - min_norm) / (1 - min_norm);
+int volume_mapping_set_normalized(struct volume_mapping *map,
+				  snd_mixer_selem_channel_id_t channel,
+				  double volume,
+				  int dir)
+{
+	long value;
+
+	map = volume_mapping_get(map);
+	if (map->err < 0)
+		return map->err;
+
+	if (map->table) {
+		value = volume_table_lookup(map->table, map->steps, volume, dir) + map->raw_min;
+		return set_raw_changed(map, channel, value);
 	}
 
-	return normalized;
+	value = volume_range_from_normalized(&map->range, volume, dir);
+	if (map->range.scale == VOLUME_MAPPING_RAW)
+		return set_raw_changed(map, channel, value);
+	return set_dB[map->ctl_dir](map->elem, channel, value, dir);
 }
 
-static int set_normalized_volume(snd_mixer_elem_t *elem,
-				 snd_mixer_selem_channel_id_t channel,
-				 double volume,
-				 int dir,
-				 enum ctl_dir ctl_dir)
+int volume_mapping_get_normalized_n(struct volume_mapping *map,
+				    const snd_mixer_selem_channel_id_t *channels,
+				    double *volumes,
+				    unsigned int count)
 {
-	long min, max, value;
-	double min_norm;
+	long values[MAX_CHANNELS];
+	unsigned int i;
 	int err;
 
-	err = get_dB_range[ctl_dir](elem, &min, &max);
-	if (err < 0 || min >= max) {
-		err = get_raw_range[ctl_dir](elem, &min, &max);
-		if (err < 0)
-			return err;
+	if (count > MAX_CHANNELS)
+		return -EINVAL;
 
-		value = lrint_dir(volume * (max - min), dir) + min;
-		return set_raw[ctl_dir](elem, channel, value);
+	map = volume_mapping_get(map);
+	if (map->err < 0) {
+		for (i = 0; i < count; i++)
+			volumes[i] = 0;
+		return map->err;
 	}
 
-	if (use_linear_dB_scale(min, max)) {
-		value = lrint_dir(volume * (max - min), dir) + min;
-		return set_dB[ctl_dir](elem, channel, value, dir);
+	for (i = 0; i < count; i++) {
+		if (map->table || map->range.scale == VOLUME_MAPPING_RAW)
+			err = get_raw[map->ctl_dir](map->elem, channels[i], &values[i]);
+		else
+			err = get_dB[map->ctl_dir](map->elem, channels[i], &values[i]);
+		if (err < 0)
+			values[i] = map->table ? map->raw_min : map->range.min;
 	}
 
-	if (min != SND_CTL_TLV_DB_GAIN_MUTE) {
-		min_norm = pow(10, (min - max) / 6000.0);
-		volume = volume * (1 - min_norm) + min_norm;
+	if (map->table) {
+		for (i = 0; i < count; i++) {
+			long value = values[i] - map->raw_min;
+
+			value = value < 0 ? 0 : value >= map->steps ? map->steps - 1 : value;
+			volumes[i] = map->table[value];
+		}
+	} else {
+		volume_range_to_normalized_n(&map->range, values, volumes, count);
 	}
-	value = lrint_dir(6000.0 * log10(volume), dir) + max;
-	return set_dB[ctl_dir](elem, channel, value, dir);
+
+	return 0;
 }
 
-double get_normalized_playback_volume(snd_mixer_elem_t *elem,
-				      snd_mixer_selem_channel_id_t channel)
+static inline unsigned int channel_bit(snd_mixer_selem_channel_id_t channel)
 {
-	return get_normalized_volume(elem, channel, PLAYBACK);
+	if (channel < 0 || channel >= MAX_CHANNELS)
+		return 0;
+	return 1u << channel;
 }
 
-double get_normalized_capture_volume(snd_mixer_elem_t *elem,
-				     snd_mixer_selem_channel_id_t channel)
+/*
+ * Writes the converted values; 'raw' tells whether they are register values
+ * or dB.  If every channel of the element gets the same value, one
+ * set_*_all call replaces the per-channel writes.
+ */
+static int volume_mapping_write_n(const struct volume_mapping *map,
+				  const snd_mixer_selem_channel_id_t *channels,
+				  const long *values,
+				  unsigned int count,
+				  bool raw,
+				  int dir)
+{
+	unsigned int covered = 0, i;
+	bool same = true;
+	int err, ret = 0;
+
+	for (i = 0; i < count; i++) {
+		covered |= channel_bit(channels[i]);
+		same = same && values[i] == values[0];
+	}
+
+	if (count > 0 && same && (map->channels & ~covered) == 0) {
+		if (!raw)
+			return set_dB_all[map->ctl_dir](map->elem, values[0], dir);
+
+		for (i = 0; i < count; i++) {
+			long current;
+
+			if (!(map->channels & channel_bit(channels[i])))
+				continue;
+			if (get_raw[map->ctl_dir](map->elem, channels[i], &current) < 0 ||
+			    current != values[0])
+				return set_raw_all[map->ctl_dir](map->elem, values[0]);
+		}
+		return 0;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (!(map->channels & channel_bit(channels[i])))
+			continue;
+
+		if (raw)
+			err = set_raw_changed(map, channels[i], values[i]);
+		else
+			err = set_dB[map->ctl_dir](map->elem, channels[i], values[i], dir);
+		if (err < 0 && ret == 0)
+			ret = err;
+	}
+
+	return ret;
+}
+
+int volume_mapping_set_normalized_n(struct volume_mapping *map,
+				    const snd_mixer_selem_channel_id_t *channels,
+				    const double *volumes,
+				    unsigned int count,
+				    int dir)
 {
-	return get_normalized_volume(elem, channel, CAPTURE);
+	long values[MAX_CHANNELS];
+	unsigned int i;
+
+	if (count > MAX_CHANNELS)
+		return -EINVAL;
+
+	map = volume_mapping_get(map);
+	if (map->err < 0)
+		return map->err;
+
+	if (map->table) {
+		volume_table_lookup_n(map->table, map->steps, volumes, values, count, dir);
+		for (i = 0; i < count; i++)
+			values[i] += map->raw_min;
+		return volume_mapping_write_n(map, channels, values, count, true, dir);
+	}
+
+	volume_range_from_normalized_n(&map->range, volumes, values, count, dir);
+	return volume_mapping_write_n(map, channels, values, count,
+				      map->range.scale == VOLUME_MAPPING_RAW, dir);
 }
 
-int set_normalized_playback_volume(snd_mixer_elem_t *elem,
-				   snd_mixer_selem_channel_id_t channel,
-				   double volume,
-				   int dir)
+/*
+ * 'volumes' holds 'count' rows of 'n_channels' values, one row per element;
+ * the first error is returned, but all elements are handled.
+ */
+int volume_mapping_get_normalized_bulk(struct volume_mapping * const *maps,
+				       unsigned int count,
+				       const snd_mixer_selem_channel_id_t *channels,
+				       unsigned int n_channels,
+				       double *volumes)
 {
-	return set_normalized_volume(elem, channel, volume, dir, PLAYBACK);
+	unsigned int i;
+	int err, ret = 0;
+
+	for (i = 0; i < count; i++) {
+		err = volume_mapping_get_normalized_n(maps[i], channels,
+						      volumes + i * n_channels, n_channels);
+		if (err < 0 && ret == 0)
+			ret = err;
+	}
+
+	return ret;
 }
 
-int set_normalized_capture_volume(snd_mixer_elem_t *elem,
-				  snd_mixer_selem_channel_id_t channel,
-				  double volume,
-				  int dir)
+int volume_mapping_set_normalized_bulk(struct volume_mapping * const *maps,
+				       unsigned int count,
+				       const snd_mixer_selem_channel_id_t *channels,
+				       unsigned int n_channels,
+				       const double *volumes,
+				       int dir)
 {
-	return set_normalized_volume(elem, channel, volume, dir, CAPTURE);
+	unsigned int i;
+	int err, ret = 0;
+
+	for (i = 0; i < count; i++) {
+		err = volume_mapping_set_normalized_n(maps[i], channels,
+						      volumes + i * n_channels, n_channels, dir);
+		if (err < 0 && ret == 0)
+			ret = err;
+	}
+
+	return ret;
 }
@@ -4,18 +4,58 @@
 /* credit to the alsa-utils development team */
 
 #include <alsa/asoundlib.h>
+#include "volume_mapping_kernel.h"
 
-double get_normalized_playback_volume(snd_mixer_elem_t *elem,
-				      snd_mixer_selem_channel_id_t channel);
-double get_normalized_capture_volume(snd_mixer_elem_t *elem,
+enum ctl_dir { PLAYBACK, CAPTURE };
+
+#define VOLUME_MAPPING_MAX_CHANNELS	(SND_MIXER_SCHN_LAST + 1)
+
+struct volume_mapping;
+
+struct volume_mapping *volume_mapping_new(snd_mixer_elem_t *elem,
+					  enum ctl_dir ctl_dir,
+					  enum volume_mapping_curve curve);
+void volume_mapping_free(struct volume_mapping *map);
+void volume_mapping_invalidate(struct volume_mapping *map);
+enum volume_mapping_scale volume_mapping_get_scale(struct volume_mapping *map);
+long volume_mapping_get_steps(struct volume_mapping *map);
+unsigned int volume_mapping_get_channels(struct volume_mapping *map,
+					 snd_mixer_selem_channel_id_t *channels);
+double volume_mapping_quantize(struct volume_mapping *map,
+			       double volume,
+			       int dir);
+double volume_mapping_step(struct volume_mapping *map,
+			   double volume,
+			   int dir);
+int volume_mapping_to_dB(struct volume_mapping *map,
+			 double volume,
+			 int dir,
+			 long *dB);
+double volume_mapping_get_normalized(struct volume_mapping *map,
 				     snd_mixer_selem_channel_id_t channel);
-int set_normalized_playback_volume(snd_mixer_elem_t *elem,
-				   snd_mixer_selem_channel_id_t channel,
-				   double volume,
-				   int dir);
-int set_normalized_capture_volume(snd_mixer_elem_t *elem,
+int volume_mapping_set_normalized(struct volume_mapping *map,
 				  snd_mixer_selem_channel_id_t channel,
 				  double volume,
 				  int dir);
+int volume_mapping_get_normalized_n(struct volume_mapping *map,
+				    const snd_mixer_selem_channel_id_t *channels,
+				    double *volumes,
+				    unsigned int count);
+int volume_mapping_set_normalized_n(struct volume_mapping *map,
+				    const snd_mixer_selem_channel_id_t *channels,
+				    const double *volumes,
+				    unsigned int count,
+				    int dir);
+int volume_mapping_get_normalized_bulk(struct volume_mapping * const *maps,
+				       unsigned int count,
+				       const snd_mixer_selem_channel_id_t *channels,
+				       unsigned int n_channels,
+				       double *volumes);
+int volume_mapping_set_normalized_bulk(struct volume_mapping * const *maps,
+				       unsigned int count,
+				       const snd_mixer_selem_channel_id_t *channels,
+				       unsigned int n_channels,
+				       const double *volumes,
+				       int dir);
 
 #endif
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2010 Clemens Ladisch <clemens@ladisch.de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <float.h>
+#include <math.h>
+#include "volume_mapping_kernel.h"
+
+#define MAX_LINEAR_DB_SCALE	24
+
+/*
+ * Positions computed in floating point may land a tiny bit beside the step
+ * they came from; rounding up or down must not move them to the next step.
+ */
+#define ROUND_EPSILON		1e-6
+#define TABLE_EPSILON		1e-9
+
+static inline bool use_linear_dB_scale(long dBmin, long dBmax)
+{
+	return dBmax - dBmin <= MAX_LINEAR_DB_SCALE * 100;
+}
+
+static long lrint_dir(double x, int dir)
+{
+	if (dir > 0)
+		return lrint(ceil(x - ROUND_EPSILON));
+	else if (dir < 0)
+		return lrint(floor(x + ROUND_EPSILON));
+	else
+		return lrint(x);
+}
+
+void volume_range_init(struct volume_range *range,
+		       enum volume_mapping_curve curve,
+		       bool have_dB, long dB_min, long dB_max,
+		       long raw_min, long raw_max)
+{
+	have_dB = have_dB && dB_min < dB_max;
+
+	if (!have_dB || curve == VOLUME_MAPPING_CURVE_RAW) {
+		range->scale = VOLUME_MAPPING_RAW;
+		range->min = raw_min;
+		range->max = raw_max;
+	} else {
+		if (curve == VOLUME_MAPPING_CURVE_LINEAR_DB ||
+		    (curve == VOLUME_MAPPING_CURVE_AUTO && use_linear_dB_scale(dB_min, dB_max)))
+			range->scale = VOLUME_MAPPING_LINEAR_DB;
+		else
+			range->scale = VOLUME_MAPPING_CUBIC;
+		range->min = dB_min;
+		range->max = dB_max;
+	}
+
+	range->min_norm = 0;
+	if (range->scale == VOLUME_MAPPING_CUBIC && dB_min != VOLUME_MAPPING_DB_GAIN_MUTE)
+		range->min_norm = pow(10, (dB_min - dB_max) / 6000.0);
+}
+
+double volume_range_to_normalized(const struct volume_range *range,
+				  long value)
+{
+	double normalized;
+
+	if (range->max <= range->min)
+		return 0;
+
+	if (range->scale == VOLUME_MAPPING_CUBIC)
+		normalized = (pow(10, (value - range->max) / 6000.0) - range->min_norm) /
+			     (1 - range->min_norm);
+	else
+		normalized = (value - range->min) / (double)(range->max - range->min);
+
+	if (normalized < 0)
+		return 0;
+	if (normalized > 1)
+		return 1;
+	return normalized;
+}
+
+long volume_range_from_normalized(const struct volume_range *range,
+				  double volume,
+				  int dir)
+{
+	long value;
+
+	if (volume <= 0)
+		return range->min;
+	if (volume >= 1)
+		return range->max;
+
+	if (range->scale == VOLUME_MAPPING_CUBIC) {
+		volume = volume * (1 - range->min_norm) + range->min_norm;
+		value = lrint_dir(6000.0 * log10(volume), dir) + range->max;
+	} else {
+		value = lrint_dir(volume * (range->max - range->min), dir) + range->min;
+	}
+
+	if (value < range->min)
+		return range->min;
+	if (value > range->max)
+		return range->max;
+	return value;
+}
+
+/*
+ * The _n variants convert whole arrays with the same results as the scalar
+ * functions.  The scale and the rounding direction are decided once per call,
+ * so the loops have no branches besides selects and clamps and the compiler
+ * can vectorize them.
+ */
+void volume_range_to_normalized_n(const struct volume_range *range,
+				  const long *values,
+				  double *volumes,
+				  unsigned int count)
+{
+	const double min = range->min, max = range->max;
+	const double min_norm = range->min_norm;
+	unsigned int i;
+
+	if (range->max <= range->min) {
+		for (i = 0; i < count; i++)
+			volumes[i] = 0;
+		return;
+	}
+
+	if (range->scale == VOLUME_MAPPING_CUBIC) {
+		for (i = 0; i < count; i++)
+			volumes[i] = (pow(10, (values[i] - max) / 6000.0) - min_norm) /
+				     (1 - min_norm);
+	} else {
+		const double span = max - min;
+
+		for (i = 0; i < count; i++)
+			volumes[i] = (values[i] - min) / span;
+	}
+
+	for (i = 0; i < count; i++)
+		volumes[i] = volumes[i] < 0 ? 0 : volumes[i] > 1 ? 1 : volumes[i];
+}
+
+void volume_range_from_normalized_n(const struct volume_range *range,
+				    const double *volumes,
+				    long *values,
+				    unsigned int count,
+				    int dir)
+{
+	const double min_norm = range->min_norm;
+	const double bias = dir > 0 ? -ROUND_EPSILON : dir < 0 ? ROUND_EPSILON : 0;
+	double (* const round_fn)(double) = dir > 0 ? ceil : dir < 0 ? floor : rint;
+	unsigned int i;
+
+	if (range->scale == VOLUME_MAPPING_CUBIC) {
+		for (i = 0; i < count; i++) {
+			double volume = volumes[i] * (1 - min_norm) + min_norm;
+			double x = 6000.0 * log10(volume > DBL_MIN ? volume : DBL_MIN);
+
+			values[i] = lrint(round_fn(x + bias)) + range->max;
+		}
+	} else {
+		const double span = range->max - range->min;
+
+		for (i = 0; i < count; i++) {
+			double volume = volumes[i] < 0 ? 0 : volumes[i] > 1 ? 1 : volumes[i];
+
+			values[i] = lrint(round_fn(volume * span + bias)) + range->min;
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		long value = values[i];
+
+		value = volumes[i] <= 0 ? range->min : volumes[i] >= 1 ? range->max : value;
+		values[i] = value < range->min ? range->min : value > range->max ? range->max : value;
+	}
+}
+
+/*
+ * Fills 'table' with the normalized position of each of the 'steps' values;
+ * the result is kept sorted so that it can be searched.
+ */
+void volume_table_fill(const struct volume_range *range,
+		       const long *values,
+		       long steps,
+		       double *table)
+{
+	long i;
+
+	for (i = 0; i < steps; i++) {
+		table[i] = volume_range_to_normalized(range, values[i]);
+		if (i > 0 && table[i] < table[i - 1])
+			table[i] = table[i - 1];
+	}
+}
+
+/* index of the table entry for 'volume', rounded in direction 'dir' */
+long volume_table_lookup(const double *table,
+			 long steps,
+			 double volume,
+			 int dir)
+{
+	long lo = 0, hi = steps;
+
+	if (volume <= table[0])
+		return 0;
+	if (volume >= table[steps - 1])
+		return steps - 1;
+
+	if (dir > 0)
+		volume -= TABLE_EPSILON;
+	else if (dir < 0)
+		volume += TABLE_EPSILON;
+
+	/* first entry >= volume */
+	while (lo < hi) {
+		long mid = lo + (hi - lo) / 2;
+
+		if (table[mid] < volume)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo == steps)
+		return steps - 1;
+	if (dir > 0 || lo == 0)
+		return lo;
+	if (dir < 0)
+		return table[lo] > volume ? lo - 1 : lo;
+	return volume - table[lo - 1] <= table[lo] - volume ? lo - 1 : lo;
+}
+
+/*
+ * Index of the first entry past 'volume' in direction 'dir' (-1/1) whose
+ * position differs from it; the first or last entry at the ends.
+ */
+long volume_table_step(const double *table,
+		       long steps,
+		       double volume,
+		       int dir)
+{
+	long i;
+
+	if (dir > 0) {
+		i = volume_table_lookup(table, steps, volume, -1);
+		while (i < steps - 1 && table[i] <= volume + TABLE_EPSILON)
+			i++;
+	} else {
+		i = volume_table_lookup(table, steps, volume, 1);
+		while (i > 0 && table[i] >= volume - TABLE_EPSILON)
+			i--;
+	}
+
+	return i;
+}
+
+void volume_table_lookup_n(const double *table,
+			   long steps,
+			   const double *volumes,
+			   long *indexes,
+			   unsigned int count,
+			   int dir)
+{
+	unsigned int i;
+
+	for (i = 0; i < count; i++)
+		indexes[i] = volume_table_lookup(table, steps, volumes[i], dir);
+}
+
+/*
+ * The normalized volume at 't' (0 - 1) of a fade from 'from' to 'to'.  The
+ * fade moves along the slider, so the curves shape a movement that already
+ * sounds even; the ends are returned exactly.
+ */
+double volume_fade_position(enum volume_fade_curve curve,
+			    double from,
+			    double to,
+			    double t)
+{
+	double shape;
+
+	if (t <= 0)
+		return from;
+	if (t >= 1)
+		return to;
+
+	switch (curve) {
+	case VOLUME_FADE_SMOOTH:
+		shape = t * t * (3 - 2 * t);
+		break;
+	case VOLUME_FADE_EASE_IN:
+		shape = t * t;
+		break;
+	case VOLUME_FADE_EASE_OUT:
+		shape = t * (2 - t);
+		break;
+	case VOLUME_FADE_LINEAR:
+	default:
+		shape = t;
+		break;
+	}
+
+	return from + (to - from) * shape;
+}
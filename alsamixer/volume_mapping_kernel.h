@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2010 Clemens Ladisch <clemens@ladisch.de>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef VOLUME_MAPPING_KERNEL_H_INCLUDED
+#define VOLUME_MAPPING_KERNEL_H_INCLUDED
+
+/*
+ * The math of volume_mapping.c on plain values, without any ALSA calls, so
+ * that it can be tested and measured without a sound card.  dB values are in
+ * 1/100 dB, as everywhere in ALSA.
+ */
+
+#include <stdbool.h>
+
+/* same value as SND_CTL_TLV_DB_GAIN_MUTE */
+#define VOLUME_MAPPING_DB_GAIN_MUTE	-9999999
+
+enum volume_mapping_scale {
+	VOLUME_MAPPING_RAW,
+	VOLUME_MAPPING_LINEAR_DB,
+	VOLUME_MAPPING_CUBIC,
+};
+
+enum volume_mapping_curve {
+	VOLUME_MAPPING_CURVE_AUTO,
+	VOLUME_MAPPING_CURVE_CUBIC,
+	VOLUME_MAPPING_CURVE_LINEAR_DB,
+	VOLUME_MAPPING_CURVE_RAW,
+};
+
+/* shapes of a fade between two normalized volumes */
+enum volume_fade_curve {
+	VOLUME_FADE_LINEAR,
+	VOLUME_FADE_SMOOTH,	/* slow at both ends */
+	VOLUME_FADE_EASE_IN,	/* slow at the start */
+	VOLUME_FADE_EASE_OUT,	/* slow at the end */
+};
+
+struct volume_range {
+	enum volume_mapping_scale scale;
+	long min, max;		/* dB or raw, depending on scale */
+	double min_norm;
+};
+
+void volume_range_init(struct volume_range *range,
+		       enum volume_mapping_curve curve,
+		       bool have_dB, long dB_min, long dB_max,
+		       long raw_min, long raw_max);
+double volume_range_to_normalized(const struct volume_range *range,
+				  long value);
+long volume_range_from_normalized(const struct volume_range *range,
+				  double volume,
+				  int dir);
+
+void volume_range_to_normalized_n(const struct volume_range *range,
+				  const long *values,
+				  double *volumes,
+				  unsigned int count);
+void volume_range_from_normalized_n(const struct volume_range *range,
+				    const double *volumes,
+				    long *values,
+				    unsigned int count,
+				    int dir);
+
+void volume_table_fill(const struct volume_range *range,
+		       const long *values,
+		       long steps,
+		       double *table);
+long volume_table_lookup(const double *table,
+			 long steps,
+			 double volume,
+			 int dir);
+long volume_table_step(const double *table,
+		       long steps,
+		       double volume,
+		       int dir);
+void volume_table_lookup_n(const double *table,
+			   long steps,
+			   const double *volumes,
+			   long *indexes,
+			   unsigned int count,
+			   int dir);
+
+double volume_fade_position(enum volume_fade_curve curve,
+			    double from,
+			    double to,
+			    double t);
+
+#endif